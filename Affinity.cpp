@@ -0,0 +1,174 @@
+#include "Affinity.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "Util.hpp"
+
+namespace {
+
+// Whole of `text` as a core number
+bool parse_core(std::string_view text, int& core) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), core);
+    return error == std::errc() && end == text.data() + text.size() && core >= 0;
+}
+
+// Parses a cpulist such as 0-3,8-11, returns false on anything else
+bool parse_cores(std::string_view list, std::vector<int>& cores) {
+    while (!list.empty()) {
+        std::string_view range = list.substr(0, list.find(','));
+        list.remove_prefix(std::min(list.size(), range.size() + 1));
+
+        size_t dash = range.find('-');
+        int first, last;
+        if (!parse_core(range.substr(0, dash), first)
+            || !parse_core(dash == std::string_view::npos ? range : range.substr(dash + 1), last)
+            || last < first) {
+            return false;
+        }
+
+        for (int core = first; core <= last; core++) {
+            cores.push_back(core);
+        }
+    }
+    return true;
+}
+
+// Cores of every NUMA node with a cpulist in sysfs, ordered by node number
+std::vector<std::vector<int>> sysfs_nodes() {
+    std::vector<std::pair<int, std::vector<int>>> found;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        std::string name = entry.path().filename();
+        if (name.size() < 5 || name.substr(0, 4) != "node" || !std::all_of(name.begin() + 4, name.end(), isdigit)) {
+            continue;
+        }
+
+        std::string list;
+        std::ifstream(entry.path() / "cpulist") >> list;
+
+        std::vector<int> cores;
+        if (parse_cores(list, cores)) {
+            found.emplace_back(std::stoi(name.substr(4)), std::move(cores));
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+
+    std::vector<std::vector<int>> nodes;
+    for (auto& [node, cores] : found) {
+        nodes.push_back(std::move(cores));
+    }
+    return nodes;
+}
+
+}
+
+std::optional<Affinity> Affinity::from_args(int argc, const char** argv) {
+    auto option = Util::option(argc, argv, "affinity");
+    if (!option) {
+        return std::nullopt;
+    }
+
+    Affinity affinity;
+    if (*option == "numa") {
+        affinity.nodes = sysfs_nodes();
+    }
+    else if (auto parsed = parse(*option)) {
+        affinity = std::move(*parsed);
+    }
+    else {
+        fprintf(stderr, "Unknown affinity: %.*s\n", (int) option->size(), option->data());
+        exit(EXIT_FAILURE);
+    }
+
+    // Only cores the process may run on, as restricted by taskset or the batch system
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    for (auto& cores : affinity.nodes) {
+        std::erase_if(cores, [&](int core) { return core < 0 || core >= CPU_SETSIZE || !CPU_ISSET(core, &allowed); });
+    }
+    std::erase_if(affinity.nodes, [](const std::vector<int>& cores) { return cores.empty(); });
+
+    if (affinity.nodes.size() < 2) {
+        return std::nullopt;
+    }
+    return affinity;
+}
+
+std::optional<Affinity> Affinity::parse(std::string_view lists) {
+    Affinity affinity;
+    while (!lists.empty()) {
+        std::string_view list = lists.substr(0, lists.find(':'));
+        lists.remove_prefix(std::min(lists.size(), list.size() + 1));
+
+        if (!parse_cores(list, affinity.nodes.emplace_back())) {
+            return std::nullopt;
+        }
+    }
+    return affinity;
+}
+
+size_t Affinity::sockets(int threads) const {
+    return std::min(nodes.size(), (size_t) std::max(threads, 1));
+}
+
+int Affinity::pin(int thread, int threads) const {
+    size_t count = sockets(threads);
+    int socket = thread % count;
+
+    const auto& cores = nodes[socket];
+    int core = cores[(thread / count) % cores.size()];
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    return socket;
+}
+
+// Cloning the variable policy copies its scan order as well
+Replica::Replica(const Problem& problem, const Branching& branching, const Bounding& bounding, float bestWeight)
+    : problem(problem)
+    , branching(branching.prioritize({}))
+    , bounding(bounding)
+    , bestWeight(bestWeight)
+{}
+
+SocketQueues::SocketQueues(size_t jobs, size_t sockets)
+    : jobs(jobs)
+    , sockets(std::max(sockets, (size_t) 1))
+    , queues(new Queue[this->sockets])
+{}
+
+std::optional<size_t> SocketQueues::next(int socket) {
+    for (size_t i = 0; i < sockets; i++) {
+        size_t queue = (socket + i) % sockets;
+
+        // Look before taking, so drained queues on other sockets are only read
+        if (queue + queues[queue].taken.load(std::memory_order_relaxed) * sockets >= jobs) {
+            continue;
+        }
+
+        size_t job = queue + queues[queue].taken.fetch_add(1, std::memory_order_relaxed) * sockets;
+        if (job < jobs) {
+            if (i > 0) {
+                stolen++;
+            }
+            return job;
+        }
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Problem.hpp"
+
+// NUMA nodes and the cores the process may use on each of them. Threads are dealt
+// round-robin over the nodes, so every socket gets an equal share, then onto consecutive cores.
+class Affinity {
+public:
+    std::vector<std::vector<int>> nodes;
+
+    // Reads --affinity numa for the topology in sysfs, or --affinity with explicit core lists
+    // such as 0-3,8-11:4-7,12-15. Nothing on a single NUMA node, so those runs stay unpinned.
+    static std::optional<Affinity> from_args(int argc, const char** argv);
+
+    // Core lists of the nodes separated by colons, each a cpulist such as 0-3,8-11. Nothing on a syntax error.
+    static std::optional<Affinity> parse(std::string_view lists);
+
+    // Sockets a team of `threads` spreads over
+    size_t sockets(int threads) const;
+
+    // Pins the calling thread onto its core, returns its socket
+    int pin(int thread, int threads) const;
+};
+
+// Everything the search reads at each node, copied onto one socket. The copy is made by
+// a thread pinned there, so its memory is first touched and allocated on that NUMA node.
+struct alignas(64) Replica {
+    // Nodes a pinned thread searches between two looks at the global incumbent weight
+    static constexpr uint64_t REFRESH = 1 << 10;
+
+    Problem problem;
+    Branching branching;
+    Bounding bounding;
+
+    // Socket-local copy of the incumbent weight to prune against. Only threads of its own socket write it,
+    // on their own improvements and every REFRESH nodes, so it may trail the global incumbent for a while.
+    float bestWeight;
+
+    Replica(const Problem& problem, const Branching& branching, const Bounding& bounding, float bestWeight);
+};
+
+// Job indices dealt round-robin to one queue per socket, keeping the promising early jobs
+// first on every socket. A thread whose socket ran dry takes from the next socket and counts a steal.
+class SocketQueues {
+public:
+    SocketQueues(size_t jobs, size_t sockets);
+
+    std::optional<size_t> next(int socket);
+
+    uint64_t steals() const {
+        return stolen;
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::atomic<size_t> taken = 0;
+    };
+
+    size_t jobs;
+    size_t sockets;
+    std::unique_ptr<Queue[]> queues;
+    std::atomic<uint64_t> stolen = 0;
+};
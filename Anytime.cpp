@@ -0,0 +1,133 @@
+#include "Anytime.hpp"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "Util.hpp"
+
+namespace {
+
+// Relative distance between incumbent and bound, infinite while there is no incumbent
+double gap(float incumbent, float bound) {
+    if (std::isinf(incumbent)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (incumbent <= 0.0f) {
+        return 0.0;
+    }
+    return std::max(0.0, double(incumbent - bound) / incumbent);
+}
+
+// JSON has no infinity, so unknown values become null
+std::string json_number(double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    return std::to_string(value);
+}
+
+}
+
+Anytime Anytime::from_args(int argc, const char** argv) {
+    Anytime result;
+
+    if (auto limit = Util::number(argc, argv, "time-limit", 0.0)) {
+        result.limit = std::chrono::duration<double>(*limit);
+        result.interval = std::chrono::duration<double>(1.0);
+    }
+
+    if (auto interval = Util::number(argc, argv, "progress", 0.0)) {
+        result.interval = std::chrono::duration<double>(*interval);
+    }
+
+    result.json = Util::option(argc, argv, "json").has_value();
+
+    return result;
+}
+
+Anytime::Anytime(const Anytime& other)
+    : limit(other.limit)
+    , interval(other.interval)
+    , json(other.json)
+    , status(other.status)
+{}
+
+Anytime& Anytime::operator=(const Anytime& other) {
+    limit = other.limit;
+    interval = other.interval;
+    json = other.json;
+    status = other.status;
+    return *this;
+}
+
+void Anytime::start() {
+    started = std::chrono::steady_clock::now();
+    nodes = 0;
+    stopped = false;
+
+    if (interval) {
+        next_progress = (started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(*interval)).time_since_epoch().count();
+    }
+}
+
+void Anytime::poll(uint64_t explored) {
+    nodes.fetch_add(explored, std::memory_order_relaxed);
+
+    auto now = std::chrono::steady_clock::now();
+
+    if (limit && now - started >= *limit) {
+        stopped.store(true, std::memory_order_relaxed);
+    }
+
+    if (interval && now.time_since_epoch().count() >= next_progress.load(std::memory_order_relaxed)) {
+        // Only one thread reports, the others carry on searching
+        std::unique_lock lock(emitting, std::try_to_lock);
+        if (lock.owns_lock() && now.time_since_epoch().count() >= next_progress) {
+            next_progress = (now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(*interval)).time_since_epoch().count();
+            emit(now);
+        }
+    }
+}
+
+void Anytime::emit(std::chrono::steady_clock::time_point now) {
+    Status current = status ? status() : Status {};
+
+    double elapsed = std::chrono::duration<double>(now - started).count();
+    uint64_t explored = nodes.load(std::memory_order_relaxed);
+    double rate = elapsed > 0.0 ? explored / elapsed : 0.0;
+
+    // Extrapolate from the share of jobs already finished
+    size_t finished = current.total_jobs - current.open_jobs;
+    double remaining = finished > 0 ? elapsed * current.open_jobs / finished : std::numeric_limits<double>::infinity();
+
+    double relative_gap = gap(current.incumbent, current.bound);
+
+    if (json) {
+        fprintf(stderr,
+            "{\"event\":\"progress\",\"elapsed\":%f,\"incumbent\":%s,\"bound\":%f,\"gap\":%s,"
+            "\"nodes\":%lu,\"nodes_per_second\":%f,\"open_jobs\":%zu,\"total_jobs\":%zu,\"remaining\":%s}\n",
+            elapsed, json_number(current.incumbent).c_str(), current.bound, json_number(relative_gap).c_str(),
+            explored, rate, current.open_jobs, current.total_jobs, json_number(remaining).c_str());
+    }
+    else {
+        fprintf(stderr,
+            "Progress: %.1fs, incumbent %f, bound %f, gap %.2f%%, %lu nodes, %.0f nodes/s, %zu/%zu jobs open, %.1fs remaining\n",
+            elapsed, current.incumbent, current.bound, 100.0 * relative_gap,
+            explored, rate, current.open_jobs, current.total_jobs, remaining);
+    }
+}
+
+void Anytime::print_result(float incumbent, float bound, uint64_t hash, FILE* out) const {
+    fprintf(out, "Instance: %016" PRIx64 "\n", hash);
+
+    if (!cancelled()) {
+        fprintf(out, "Status: optimal\n");
+        return;
+    }
+
+    fprintf(out, "Status: time limit reached, not proven optimal\n");
+    fprintf(out, "Lower bound: %f\n", bound);
+    fprintf(out, "Gap: %.2f%%\n", 100.0 * gap(incumbent, bound));
+}
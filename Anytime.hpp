@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+
+// Time limit, cooperative cancellation and periodic progress events shared by the engines
+class Anytime {
+public:
+    // Nodes a thread explores between two looks at the clock
+    static constexpr uint64_t POLL = 1 << 12;
+
+    // Search state for progress events, filled in by the engine
+    struct Status {
+        float incumbent = std::numeric_limits<float>::infinity();
+        float bound = 0.0f;
+        size_t open_jobs = 0;
+        size_t total_jobs = 0;
+    };
+
+    std::optional<std::chrono::duration<double>> limit;
+    std::optional<std::chrono::duration<double>> interval;
+    bool json = false;
+
+    // Called from whichever thread emits a progress event
+    std::function<Status()> status;
+
+    // Reads --time-limit SECONDS, --progress SECONDS and --json.
+    // Progress is reported every second by default once a time limit is set.
+    static Anytime from_args(int argc, const char** argv);
+
+    Anytime() = default;
+    Anytime(const Anytime& other);
+    Anytime& operator=(const Anytime& other);
+
+    bool enabled() const {
+        return limit || interval;
+    }
+
+    void start();
+
+    // Cheap enough for every search node, `nodes` is the calling thread's node counter
+    bool cancelled(uint64_t nodes) {
+        if (enabled() && (nodes & (POLL - 1)) == 0) {
+            poll(POLL);
+        }
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    // Accounts for `nodes` more nodes, then checks the deadline and emits progress when due
+    void poll(uint64_t nodes);
+
+    // Prints the status line of the final report, the run is optimal when it was never cancelled.
+    // The instance hash lets a later --previous prove that an optimum belongs to its base instance.
+    void print_result(float incumbent, float bound, uint64_t hash, FILE* out = stdout) const;
+
+private:
+    void emit(std::chrono::steady_clock::time_point now);
+
+    std::chrono::steady_clock::time_point started;
+    std::atomic<std::chrono::steady_clock::rep> next_progress = 0;
+    std::atomic<uint64_t> nodes = 0;
+    std::atomic<bool> stopped = false;
+    std::mutex emitting;
+};
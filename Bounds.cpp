@@ -0,0 +1,249 @@
+#include "Bounds.hpp"
+
+#include <algorithm>
+#include <deque>
+
+#include "Util.hpp"
+
+namespace {
+
+constexpr float EPSILON = 1e-6f;
+
+// Kept off every flow value, so float rounding can never prune the optimum
+constexpr float TOLERANCE = 1e-4f;
+
+// Buffers reused across calls, bounds are computed at nearly every node
+struct Scratch {
+    std::vector<int> vertex;
+    std::vector<float> capacity;
+    std::vector<float> residual;
+    std::vector<std::pair<int, int>> commodities;
+
+    // Push-relabel state, the queues never hold a vertex twice so they stay within one deque block
+    std::vector<int> height;
+    std::vector<int> count;
+    std::vector<float> excess;
+    std::vector<int> current;
+    std::deque<int> active;
+    std::deque<int> frontier;
+};
+
+thread_local Scratch scratch;
+
+}
+
+FlowBound::FlowBound(const Problem& problem)
+    : n(problem.n)
+    , edges(problem.edges)
+{
+    for (auto [a, b] : problem.exclusions) {
+        pairs.emplace_back(a, b);
+    }
+    std::sort(pairs.begin(), pairs.end());
+}
+
+float FlowBound::remaining(const VSolution& solution) const {
+    // Contract each side into a single terminal, unassigned nodes keep their own vertex
+    constexpr int S = 0;
+    constexpr int T = 1;
+
+    auto& vertex = scratch.vertex;
+    auto& capacity = scratch.capacity;
+    auto& residual = scratch.residual;
+    auto& commodities = scratch.commodities;
+    vertex.resize(n);
+    int size = 2;
+    bool has_s = false;
+    bool has_t = false;
+
+    for (Node i = 0; i < n; i++) {
+        if (solution[i] == 1) {
+            vertex[i] = S;
+            has_s = true;
+        }
+        else if (solution[i] == 2) {
+            vertex[i] = T;
+            has_t = true;
+        }
+        else {
+            vertex[i] = size++;
+        }
+    }
+
+    // Edges between or within the terminals are already decided
+    capacity.assign(size * size, 0.0f);
+    for (auto [a, b, v] : edges) {
+        int u = vertex[a];
+        int w = vertex[b];
+
+        if (u == w || (u < 2 && w < 2)) {
+            continue;
+        }
+
+        capacity[u * size + w] += v;
+        capacity[w * size + u] += v;
+    }
+
+    // Terminal pairs, each routed through whatever capacity the previous ones left
+    commodities.clear();
+    if (has_s && has_t) {
+        commodities.emplace_back(S, T);
+    }
+    for (auto [a, b] : pairs) {
+        if (solution[a] == 0 && solution[b] == 0) {
+            commodities.emplace_back(vertex[a], vertex[b]);
+        }
+    }
+
+    float total = 0.0f;
+
+    for (auto [s, t] : commodities) {
+        residual = capacity;
+        total += std::max(0.0f, max_flow(residual, size, s, t) - TOLERANCE);
+
+        // An undirected edge carrying flow f keeps c - |f| in both directions
+        for (int u = 0; u < size; u++) {
+            for (int w = u + 1; w < size; w++) {
+                float left = std::max(0.0f, std::min(residual[u * size + w], residual[w * size + u]));
+                capacity[u * size + w] = left;
+                capacity[w * size + u] = left;
+            }
+        }
+    }
+
+    return total;
+}
+
+float FlowBound::max_flow(std::vector<float>& residual, int size, int s, int t) {
+    // Only the first phase of push-relabel runs: excess that cannot reach t stays where it is.
+    // That leaves a preflow which carries the maximum flow value into t and uses at least
+    // as much capacity as the flow itself, so later commodities only see less capacity.
+    auto& height = scratch.height;
+    auto& count = scratch.count;
+    auto& excess = scratch.excess;
+    auto& current = scratch.current;
+    auto& active = scratch.active;
+    auto& frontier = scratch.frontier;
+
+    height.assign(size, size);
+    count.assign(2 * size + 1, 0);
+    excess.assign(size, 0.0f);
+    current.assign(size, 0);
+    active.clear();
+
+    // Exact distance labels to t
+    frontier.assign(1, t);
+    height[t] = 0;
+    while (!frontier.empty()) {
+        int v = frontier.front();
+        frontier.pop_front();
+
+        for (int u = 0; u < size; u++) {
+            if (height[u] == size && u != t && residual[u * size + v] > EPSILON) {
+                height[u] = height[v] + 1;
+                frontier.push_back(u);
+            }
+        }
+    }
+
+    // Source cut off from the sink
+    if (height[s] == size) {
+        return 0.0f;
+    }
+
+    height[s] = size;
+    for (int v = 0; v < size; v++) {
+        count[height[v]]++;
+    }
+
+    // Saturate everything leaving the source
+    for (int v = 0; v < size; v++) {
+        float c = residual[s * size + v];
+        if (c > EPSILON) {
+            residual[s * size + v] = 0.0f;
+            residual[v * size + s] += c;
+            excess[v] += c;
+
+            if (v != t && height[v] < size) {
+                active.push_back(v);
+            }
+        }
+    }
+
+    // FIFO discharge
+    while (!active.empty()) {
+        int u = active.front();
+        active.pop_front();
+
+        while (excess[u] > EPSILON && height[u] < size) {
+            if (current[u] == size) {
+                // Relabel
+                int old = height[u];
+                int lowest = 2 * size;
+                for (int v = 0; v < size; v++) {
+                    if (residual[u * size + v] > EPSILON) {
+                        lowest = std::min(lowest, height[v]);
+                    }
+                }
+
+                count[old]--;
+                height[u] = std::min(lowest + 1, size);
+                count[height[u]]++;
+                current[u] = 0;
+
+                // Gap: nothing above the emptied height can reach t any more
+                if (count[old] == 0) {
+                    for (int v = 0; v < size; v++) {
+                        if (v != s && height[v] > old && height[v] < size) {
+                            count[height[v]]--;
+                            height[v] = size;
+                            count[size]++;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            int v = current[u];
+            float c = residual[u * size + v];
+
+            if (c > EPSILON && height[u] == height[v] + 1) {
+                float pushed = std::min(excess[u], c);
+                residual[u * size + v] -= pushed;
+                residual[v * size + u] += pushed;
+                excess[u] -= pushed;
+
+                if (v != t && excess[v] <= EPSILON) {
+                    active.push_back(v);
+                }
+                excess[v] += pushed;
+            }
+            else {
+                current[u]++;
+            }
+        }
+    }
+
+    return excess[t];
+}
+
+float ShiftBound::at(const VSolution& solution) const {
+    float result = base;
+    for (auto [a, b, delta] : changes) {
+        if (solution[a] != 0 && solution[b] != 0) {
+            result += solution[a] != solution[b] ? delta : 0.0f;
+        }
+        else {
+            result += std::min(0.0f, delta);
+        }
+    }
+    return result;
+}
+
+Bounding Bounding::from_args(const Problem& problem, int argc, const char** argv) {
+    return {
+        FlowBound(problem),
+        Util::number(argc, argv, "flow-depth", 0).value_or((int) problem.n / DEFAULT_FLOW_DIVISOR),
+        std::nullopt,
+    };
+}
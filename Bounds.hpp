@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "Problem.hpp"
+
+// Lower bounds from maximum flows. Every completion of a partial assignment has to separate
+// the side 1 nodes from the side 2 nodes and the two nodes of every open exclusion pair,
+// so any flow packing between those terminals bounds the cut weight still to be added.
+class FlowBound {
+public:
+    FlowBound() = default;
+    explicit FlowBound(const Problem& problem);
+
+    // Cut weight every completion of `solution` still has to add, on top of the weight it carries
+    float remaining(const VSolution& solution) const;
+
+private:
+    // Push-relabel on a dense residual matrix, returns the value of a maximum s-t flow
+    static float max_flow(std::vector<float>& residual, int size, int s, int t);
+
+    uint32_t n = 0;
+    std::vector<Edge> edges;
+    std::vector<std::pair<Node, Node>> pairs;
+};
+
+// Bound of a re-solve after edge weight changes: every assignment weighs at least the base optimum
+// plus the weight change of each changed edge it cuts. Undecided edges count only when they got lighter.
+struct ShiftBound {
+    float base = 0.0f;
+
+    // Weight differences, new minus old
+    std::vector<Edge> changes;
+
+    float at(const VSolution& solution) const;
+};
+
+// Flow bounds are recomputed in the top 1/DEFAULT_FLOW_DIVISOR of the decisions unless --flow-depth
+// says otherwise. Deeper nodes mostly inherit the bound, computing it there costs about as much as it prunes.
+constexpr int DEFAULT_FLOW_DIVISOR = 2;
+
+// Flow bounds recomputed at nodes shallower than `depth` and inherited by everything below
+struct Bounding {
+    FlowBound flow;
+    int depth = 0;
+    std::optional<ShiftBound> shift;
+
+    // Lower bound on every completion of a node `level` decisions deep that carries `weight`,
+    // `inherited` being the bound of its parent
+    float tighten(const VSolution& solution, float weight, float inherited, int level) const {
+        float bound = std::max(weight, inherited);
+        if (level < depth) {
+            bound = std::max(bound, weight + flow.remaining(solution));
+        }
+        if (shift) {
+            bound = std::max(bound, shift->at(solution));
+        }
+        return bound;
+    }
+
+    // Reads --flow-depth D, n / DEFAULT_FLOW_DIVISOR by default
+    static Bounding from_args(const Problem& problem, int argc, const char** argv);
+};
@@ -0,0 +1,254 @@
+#include "Branching.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+
+#include "Util.hpp"
+
+namespace {
+
+// Lowest unassigned index first, the order the solvers have always used
+class StaticVariable : public VariablePolicy {
+public:
+    const char* name() const override { return "static"; }
+    std::shared_ptr<VariablePolicy> clone() const override { return std::make_shared<StaticVariable>(*this); }
+
+    Node select(const Problem& problem, const VSolution& solution) const override {
+        for (Node i : order) {
+            if (solution[i] == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
+
+// Node whose two sides differ the most in cost, so the decision matters early
+class DifferenceVariable : public VariablePolicy {
+public:
+    const char* name() const override { return "difference"; }
+    std::shared_ptr<VariablePolicy> clone() const override { return std::make_shared<DifferenceVariable>(*this); }
+
+    Node select(const Problem& problem, const VSolution& solution) const override {
+        Node best = -1;
+        float bestDifference = -1.0f;
+
+        for (Node i : order) {
+            if (solution[i] != 0) {
+                continue;
+            }
+
+            float difference = std::fabs(Branching::cost(problem, solution, i, 1) - Branching::cost(problem, solution, i, 2));
+            if (difference > bestDifference) {
+                best = i;
+                bestDifference = difference;
+            }
+        }
+        return best;
+    }
+};
+
+// Node with the most assigned neighbours, so its cost is known most precisely
+class NeighboursVariable : public VariablePolicy {
+public:
+    const char* name() const override { return "neighbours"; }
+    std::shared_ptr<VariablePolicy> clone() const override { return std::make_shared<NeighboursVariable>(*this); }
+
+    Node select(const Problem& problem, const VSolution& solution) const override {
+        Node best = -1;
+        int bestCount = -1;
+
+        for (Node i : order) {
+            if (solution[i] != 0) {
+                continue;
+            }
+
+            int count = 0;
+            for (auto [m, v] : problem.adjacency[i]) {
+                count += solution[m] != 0;
+            }
+
+            if (count > bestCount) {
+                best = i;
+                bestCount = count;
+            }
+        }
+        return best;
+    }
+};
+
+// Side 1 before side 2
+class StaticValue : public ValuePolicy {
+public:
+    const char* name() const override { return "static"; }
+
+    uint8_t first(const Problem&, const VSolution&, Node) const override {
+        return 1;
+    }
+};
+
+// Cheaper side first, which tightens the incumbent sooner
+class CheapestValue : public ValuePolicy {
+public:
+    const char* name() const override { return "cheapest"; }
+
+    uint8_t first(const Problem& problem, const VSolution& solution, Node node) const override {
+        return Branching::cost(problem, solution, node, 1) <= Branching::cost(problem, solution, node, 2) ? 1 : 2;
+    }
+};
+
+float side_cost(const Problem& problem, const VSolution& solution, Node node, uint8_t side) {
+    float weight = 0.0f;
+    for (auto [m, v] : problem.adjacency[node]) {
+        if (solution[m] != 0 && solution[m] != side) {
+            weight += v;
+        }
+    }
+    return weight;
+}
+
+// Seeds are plain decimal numbers, anything else is reported like an unknown policy name
+uint32_t parse_seed(std::string_view seed, std::string_view spec) {
+    uint32_t result = 0;
+    auto [end, error] = std::from_chars(seed.data(), seed.data() + seed.size(), result);
+
+    if (seed.empty() || error != std::errc() || end != seed.data() + seed.size()) {
+        fprintf(stderr, "Unknown seed: %.*s\n", (int) spec.size(), spec.data());
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+}
+
+std::string Branching::name() const {
+    std::string result = std::string(variable->name()) + "/" + value->name();
+    if (seed != 0) {
+        result += "@" + std::to_string(seed);
+    }
+    return result;
+}
+
+Branching Branching::prioritize(const std::vector<Node>& nodes) const {
+    auto policy = variable->clone();
+
+    std::vector<Node> order;
+    std::vector<bool> taken(policy->order.size());
+    for (Node node : nodes) {
+        if (!taken[node]) {
+            order.push_back(node);
+            taken[node] = true;
+        }
+    }
+    for (Node node : policy->order) {
+        if (!taken[node]) {
+            order.push_back(node);
+        }
+    }
+    policy->order = std::move(order);
+
+    Branching result = *this;
+    result.variable = std::move(policy);
+    return result;
+}
+
+Branching Branching::create(const Problem& problem, std::string_view variable, std::string_view value, uint32_t seed) {
+    Branching result;
+    result.seed = seed;
+
+    std::shared_ptr<VariablePolicy> policy;
+    if (variable == "static") {
+        policy = std::make_shared<StaticVariable>();
+    }
+    else if (variable == "difference") {
+        policy = std::make_shared<DifferenceVariable>();
+    }
+    else if (variable == "neighbours") {
+        policy = std::make_shared<NeighboursVariable>();
+    }
+    else {
+        fprintf(stderr, "Unknown branching policy: %.*s\n", (int) variable.size(), variable.data());
+        exit(EXIT_FAILURE);
+    }
+
+    policy->order.resize(problem.n);
+    std::iota(policy->order.begin(), policy->order.end(), 0);
+    if (seed != 0) {
+        std::shuffle(policy->order.begin(), policy->order.end(), std::mt19937(seed));
+    }
+    result.variable = std::move(policy);
+
+    if (value == "static") {
+        result.value = std::make_shared<StaticValue>();
+    }
+    else if (value == "cheapest") {
+        result.value = std::make_shared<CheapestValue>();
+    }
+    else {
+        fprintf(stderr, "Unknown value policy: %.*s\n", (int) value.size(), value.data());
+        exit(EXIT_FAILURE);
+    }
+
+    return result;
+}
+
+Branching Branching::parse(const Problem& problem, std::string_view spec) {
+    uint32_t seed = 0;
+
+    auto at = spec.find('@');
+    if (at != std::string_view::npos) {
+        seed = parse_seed(spec.substr(at + 1), spec);
+        spec = spec.substr(0, at);
+    }
+
+    auto slash = spec.find('/');
+    if (slash == std::string_view::npos) {
+        return create(problem, spec, "static", seed);
+    }
+
+    return create(problem, spec.substr(0, slash), spec.substr(slash + 1), seed);
+}
+
+Branching Branching::from_args(const Problem& problem, int argc, const char** argv) {
+    auto seed = Util::option(argc, argv, "seed");
+
+    return create(
+        problem,
+        Util::option(argc, argv, "branching").value_or("static"),
+        Util::option(argc, argv, "values").value_or("static"),
+        seed ? parse_seed(*seed, *seed) : 0
+    );
+}
+
+float Branching::cost(const Problem& problem, const VSolution& solution, Node node, uint8_t side) {
+    float weight = side_cost(problem, solution, node, side);
+
+    Node partner = problem.partners[node];
+    if (partner >= 0 && solution[partner] == 0) {
+        weight += side_cost(problem, solution, partner, Util::invert(side));
+    }
+
+    return weight;
+}
+
+float Branching::assign(const Problem& problem, VSolution& solution, Node node, uint8_t side) {
+    solution[node] = side;
+    float weight = side_cost(problem, solution, node, side);
+
+    Node partner = problem.partners[node];
+    if (partner >= 0) {
+        if (solution[partner] == 0) {
+            solution[partner] = Util::invert(side);
+            weight += side_cost(problem, solution, partner, solution[partner]);
+        }
+        assert(solution[partner] != side);
+    }
+
+    return weight;
+}
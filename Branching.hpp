@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Problem.hpp"
+
+// Decides which unassigned node to branch on next
+class VariablePolicy {
+public:
+    // Candidates are scanned in this order, so it also breaks ties
+    std::vector<Node> order;
+
+    virtual ~VariablePolicy() = default;
+    virtual const char* name() const = 0;
+    virtual std::shared_ptr<VariablePolicy> clone() const = 0;
+
+    // Returns -1 once every node is assigned
+    virtual Node select(const Problem& problem, const VSolution& solution) const = 0;
+};
+
+// Decides which side of the chosen node is explored first
+class ValuePolicy {
+public:
+    virtual ~ValuePolicy() = default;
+    virtual const char* name() const = 0;
+
+    virtual uint8_t first(const Problem& problem, const VSolution& solution, Node node) const = 0;
+};
+
+class Branching {
+public:
+    std::shared_ptr<const VariablePolicy> variable;
+    std::shared_ptr<const ValuePolicy> value;
+    uint32_t seed = 0;
+
+    Node select(const Problem& problem, const VSolution& solution) const {
+        return variable->select(problem, solution);
+    }
+
+    uint8_t first(const Problem& problem, const VSolution& solution, Node node) const {
+        return value->first(problem, solution, node);
+    }
+
+    std::string name() const;
+
+    // Same policies with `nodes` scanned before every other node, in the given order
+    Branching prioritize(const std::vector<Node>& nodes) const;
+
+    // Known names are static, difference and neighbours for variables and static and cheapest for values.
+    // A non-zero seed shuffles the order in which candidate nodes are scanned.
+    static Branching create(const Problem& problem, std::string_view variable, std::string_view value, uint32_t seed = 0);
+
+    // Parses `variable/value[@seed]` as printed by name()
+    static Branching parse(const Problem& problem, std::string_view spec);
+
+    // Reads --branching, --values and --seed, defaulting to the static index order
+    static Branching from_args(const Problem& problem, int argc, const char** argv);
+
+    // Cut weight added by placing `node` (and its exclusion partner on the other side)
+    // onto `side`, counting only neighbours that are already assigned
+    static float cost(const Problem& problem, const VSolution& solution, Node node, uint8_t side);
+
+    // Places `node` onto `side` and its exclusion partner onto the other side,
+    // returns the cut weight this adds
+    static float assign(const Problem& problem, VSolution& solution, Node node, uint8_t side);
+};
@@ -0,0 +1,222 @@
+#include "Checkpoint.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "Util.hpp"
+
+namespace {
+
+constexpr char MAGIC[8] = { 'P', 'D', 'P', 'C', 'K', 'P', 'T', '2' };
+
+template <typename T>
+bool write_value(FILE* file, const T& value) {
+    return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+bool read_value(FILE* file, T& value) {
+    return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+// Sides take two bits each, four nodes to a byte
+bool write_solution(FILE* file, const VSolution& solution, uint32_t n) {
+    std::vector<uint8_t> packed((n + 3) / 4);
+    for (uint32_t i = 0; i < n && i < solution.size(); i++) {
+        packed[i / 4] |= solution[i] << (2 * (i % 4));
+    }
+    return fwrite(packed.data(), 1, packed.size(), file) == packed.size();
+}
+
+bool read_solution(FILE* file, VSolution& solution, uint32_t n) {
+    std::vector<uint8_t> packed((n + 3) / 4);
+    if (fread(packed.data(), 1, packed.size(), file) != packed.size()) {
+        return false;
+    }
+
+    solution.resize(n);
+    for (uint32_t i = 0; i < n; i++) {
+        solution[i] = (packed[i / 4] >> (2 * (i % 4))) & 3;
+    }
+    return true;
+}
+
+[[noreturn]] void corrupt(const std::string& path) {
+    fprintf(stderr, "Invalid checkpoint: %s\n", path.c_str());
+    exit(EXIT_FAILURE);
+}
+
+}
+
+bool Checkpoint::write(const std::string& path, uint64_t hash) const {
+    // Write next to the target and rename, so a crash never leaves a torn checkpoint
+    std::string temporary = path + ".tmp";
+
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot write checkpoint: %s\n", temporary.c_str());
+        return false;
+    }
+
+    uint32_t n = jobs.empty() ? bestSolution.size() : jobs.front().solution.size();
+    uint64_t job_count = jobs.size();
+
+    bool written = fwrite(MAGIC, 1, sizeof(MAGIC), file) == sizeof(MAGIC)
+        && write_value(file, hash)
+        && write_value(file, n)
+        && write_value(file, bestWeight)
+        && write_solution(file, bestSolution, n)
+        && write_value(file, nodes)
+        && write_value(file, elapsed)
+        && write_value(file, job_count);
+
+    for (size_t i = 0; written && i < jobs.size(); i++) {
+        written = write_value(file, (int32_t) jobs[i].depth)
+            && write_value(file, jobs[i].weight)
+            && write_solution(file, jobs[i].solution, n);
+    }
+
+    // A full disk may only show up when the buffer is flushed or the file closed
+    written = written && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    written = fclose(file) == 0 && written;
+
+    // The previous checkpoint stays in place unless the new one is complete
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0) {
+        fprintf(stderr, "Cannot write checkpoint: %s\n", path.c_str());
+        remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+Checkpoint Checkpoint::read(const std::string& path, const Problem& problem) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot read checkpoint: %s\n", path.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    Checkpoint result;
+
+    char magic[sizeof(MAGIC)];
+    uint64_t hash;
+    uint32_t n;
+    uint64_t job_count;
+
+    bool valid = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0
+        && read_value(file, hash);
+
+    // Jobs and incumbent of another instance would make the resumed search report a wrong optimum
+    if (valid && hash != problem.hash()) {
+        fclose(file);
+        fprintf(stderr, "Checkpoint belongs to another instance: %s\n", path.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    valid = valid && read_value(file, n) && (n == problem.n || n == 0)
+        && read_value(file, result.bestWeight)
+        && read_solution(file, result.bestSolution, n)
+        && read_value(file, result.nodes)
+        && read_value(file, result.elapsed)
+        && read_value(file, job_count);
+
+    for (uint64_t i = 0; valid && i < job_count; i++) {
+        int32_t depth;
+        SuspendedExecution job;
+
+        valid = read_value(file, depth) && read_value(file, job.weight) && read_solution(file, job.solution, n);
+        job.depth = depth;
+
+        result.jobs.push_back(std::move(job));
+    }
+
+    fclose(file);
+
+    if (!valid) {
+        corrupt(path);
+    }
+
+    // No incumbent was found before the checkpoint
+    if (result.bestWeight == std::numeric_limits<float>::infinity()) {
+        result.bestSolution.clear();
+    }
+
+    return result;
+}
+
+std::optional<Checkpoint> Checkpoint::from_args(const Problem& problem, int argc, const char** argv) {
+    auto path = Util::option(argc, argv, "resume");
+    if (!path) {
+        return std::nullopt;
+    }
+
+    return read(std::string(*path), problem);
+}
+
+CheckpointWriter::CheckpointWriter(std::string path, uint64_t hash, std::chrono::duration<double> interval)
+    : path(std::move(path))
+    , hash(hash)
+    , interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval))
+    , next((std::chrono::steady_clock::now() + this->interval).time_since_epoch().count())
+    , thread(&CheckpointWriter::run, this)
+{}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    pending_changed.notify_one();
+    thread.join();
+}
+
+bool CheckpointWriter::due() const {
+    return std::chrono::steady_clock::now().time_since_epoch().count() >= next.load(std::memory_order_relaxed);
+}
+
+void CheckpointWriter::save(Checkpoint checkpoint) {
+    next = (std::chrono::steady_clock::now() + interval).time_since_epoch().count();
+
+    {
+        std::lock_guard lock(mutex);
+        pending = std::move(checkpoint);
+    }
+    pending_changed.notify_one();
+}
+
+void CheckpointWriter::run() {
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        pending_changed.wait(lock, [&] { return pending || stopping; });
+
+        if (pending) {
+            Checkpoint checkpoint = std::move(*pending);
+            pending.reset();
+
+            lock.unlock();
+            checkpoint.write(path, hash);
+            lock.lock();
+        }
+        else if (stopping) {
+            return;
+        }
+    }
+}
+
+std::unique_ptr<CheckpointWriter> CheckpointWriter::from_args(const Problem& problem, int argc, const char** argv) {
+    auto path = Util::option(argc, argv, "checkpoint");
+    if (!path) {
+        return nullptr;
+    }
+
+    return std::make_unique<CheckpointWriter>(
+        std::string(*path),
+        problem.hash(),
+        std::chrono::duration<double>(Util::number(argc, argv, "checkpoint-interval", 0.0).value_or(60.0))
+    );
+}
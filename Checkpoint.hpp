@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Problem.hpp"
+#include "SuspendedExecution.hpp"
+
+// Snapshot of a solve: the incumbent, accumulated statistics and every job not finished yet
+struct Checkpoint {
+    VSolution bestSolution;
+    float bestWeight = std::numeric_limits<float>::infinity();
+
+    uint64_t nodes = 0;
+    double elapsed = 0.0;
+
+    std::vector<SuspendedExecution> jobs;
+
+    // Tags the file with the instance hash, returns false and keeps any older file when a write fails
+    bool write(const std::string& path, uint64_t hash) const;
+
+    // Exits on a corrupt file or one written for another instance
+    static Checkpoint read(const std::string& path, const Problem& problem);
+
+    // Reads the file named by --resume, if any
+    static std::optional<Checkpoint> from_args(const Problem& problem, int argc, const char** argv);
+};
+
+// Writes snapshots on a background thread so the search never waits for the disk
+class CheckpointWriter {
+public:
+    CheckpointWriter(std::string path, uint64_t hash, std::chrono::duration<double> interval);
+
+    // Flushes the last snapshot
+    ~CheckpointWriter();
+
+    // Whether the interval has passed since the last snapshot, cheap enough to ask after every job
+    bool due() const;
+
+    // Replaces any snapshot still waiting to be written
+    void save(Checkpoint checkpoint);
+
+    // Reads --checkpoint PATH and --checkpoint-interval SECONDS (60 by default)
+    static std::unique_ptr<CheckpointWriter> from_args(const Problem& problem, int argc, const char** argv);
+
+private:
+    void run();
+
+    std::string path;
+    uint64_t hash;
+    std::chrono::steady_clock::duration interval;
+    std::atomic<std::chrono::steady_clock::rep> next;
+
+    std::mutex mutex;
+    std::condition_variable pending_changed;
+    std::optional<Checkpoint> pending;
+    bool stopping = false;
+
+    std::thread thread;
+};
@@ -1,6 +1,11 @@
 #include "Problem.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <string>
 
 #include <mpi.h>
@@ -10,31 +15,144 @@
 using namespace std::string_literals;
 
 Problem Problem::load(std::string_view path) {
+    FILE *file = fopen(path.data(), "r");
+    assert(file);
+
+    Problem p = Problem::read(file, path);
+
+    fclose(file);
+
+    if (p.n == 0) {
+        fprintf(stderr, "Invalid problem: %.*s\n", (int) path.size(), path.data());
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+Problem Problem::read(FILE *file, std::string_view name) {
     Problem p;
 
-    p.name = path;
+    p.name = name;
 
-    FILE *file = fopen(path.data(), "r");
-    assert(file);
+    auto invalid = [&]() {
+        Problem empty;
+        empty.name = name;
+        return empty;
+    };
 
-    fscanf(file, "%u %u %u", &p.n, &p.k, &p.b);
+    if (fscanf(file, "%u %u %u", &p.n, &p.k, &p.b) != 3) {
+        return invalid();
+    }
+
+    auto node = [&](Node v) {
+        return v >= 0 && (uint32_t) v < p.n;
+    };
 
     Node a, b;
     float value;
     for (int32_t i = 0; i < p.n * p.k / 2; i++) {
-        fscanf(file, "%u %u %f", &a, &b, &value);
+        if (fscanf(file, "%d %d %f", &a, &b, &value) != 3 || !node(a) || !node(b) || a == b || !(value >= 0.0f) || std::isinf(value)) {
+            return invalid();
+        }
         p.edges.emplace_back(a, b, value);
     }
 
+    // Exclusion pairs have to be disjoint, every node has at most one partner
+    std::vector<bool> paired(p.n);
     for (int32_t i = 0; i < p.b; i++) {
-        fscanf(file, "%u %u", &a, &b);
+        if (fscanf(file, "%d %d", &a, &b) != 2 || !node(a) || !node(b) || a == b || paired[a] || paired[b]) {
+            return invalid();
+        }
+        paired[a] = paired[b] = true;
         p.exclusions[a] = b;
     }
 
-    fclose(file);
+    p.index();
     return p;
 }
 
+void Problem::index() {
+    adjacency.assign(n, {});
+    for (auto [a, b, v] : edges) {
+        adjacency[a].emplace_back(b, v);
+        adjacency[b].emplace_back(a, v);
+    }
+
+    // Exclusion pairs are disjoint, so every node has at most one partner
+    partners.assign(n, -1);
+    for (auto [a, b] : exclusions) {
+        partners[a] = b;
+        partners[b] = a;
+    }
+}
+
+uint64_t Problem::hash() const {
+    // FNV-1a over n, the sorted edges and the sorted exclusion pairs, each stored smaller node first
+    uint64_t result = 14695981039346656037ull;
+    auto mix = [&](uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            result ^= (value >> (8 * i)) & 0xff;
+            result *= 1099511628211ull;
+        }
+    };
+
+    std::vector<Edge> sorted_edges;
+    for (auto [a, b, v] : edges) {
+        sorted_edges.emplace_back(std::min(a, b), std::max(a, b), v == 0.0f ? 0.0f : v);
+    }
+    std::sort(sorted_edges.begin(), sorted_edges.end());
+
+    std::vector<std::pair<Node, Node>> sorted_exclusions;
+    for (auto [a, b] : exclusions) {
+        sorted_exclusions.emplace_back(std::min(a, b), std::max(a, b));
+    }
+    std::sort(sorted_exclusions.begin(), sorted_exclusions.end());
+
+    mix(n);
+    mix(sorted_edges.size());
+    for (auto [a, b, v] : sorted_edges) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        mix(a);
+        mix(b);
+        mix(bits);
+    }
+
+    mix(sorted_exclusions.size());
+    for (auto [a, b] : sorted_exclusions) {
+        mix(a);
+        mix(b);
+    }
+
+    return result;
+}
+
+float Problem::cut(const VSolution& solution) const {
+    if (solution.size() != n) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    for (Node i = 0; i < n; i++) {
+        if (solution[i] != 1 && solution[i] != 2) {
+            return std::numeric_limits<float>::infinity();
+        }
+    }
+
+    for (auto [a, b] : exclusions) {
+        if (solution[a] == solution[b]) {
+            return std::numeric_limits<float>::infinity();
+        }
+    }
+
+    float weight = 0.0f;
+    for (auto [a, b, v] : edges) {
+        if (solution[a] != solution[b]) {
+            weight += v;
+        }
+    }
+    return weight;
+}
+
 Problem Problem::load(int argc, const char **argv) {
     if (argc < 2) {
         Util::print_usage_and_exit(argc, argv);
@@ -108,6 +226,7 @@ Problem Problem::receive(int src) {
         result.exclusions[a] = b;
     }
 
+    result.index();
     return result;
 }
 
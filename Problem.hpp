@@ -1,13 +1,19 @@
 #pragma once
 
 #include <cstdint>
+#include <cstdio>
 #include <vector>
 #include <unordered_map>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <utility>
 
 using Node = int32_t;
 using Edge = std::tuple<Node, Node, float>;
+using Neighbour = std::pair<Node, float>;
 using Solution = uint64_t;
+using VSolution = std::vector<uint8_t>;
 
 class Problem {
 public:
@@ -20,9 +26,27 @@ public:
     std::vector<Edge> edges;
     std::unordered_map<Node, Node> exclusions;
 
+    // Derived from edges and exclusions by index()
+    std::vector<std::vector<Neighbour>> adjacency;
+    std::vector<Node> partners;
+
     static Problem load(int argc, const char** argv);
     static Problem load(std::string_view path);
 
+    // Reads one instance in the text format from an open stream. n is 0 if the header is missing, the text ends
+    // early, a weight is negative or infinite, or an edge or exclusion names a node outside 0..n-1 or the same
+    // node twice. Exclusion pairs have to be disjoint.
+    static Problem read(FILE* file, std::string_view name);
+
+    // Build adjacency lists and the symmetric exclusion partner table
+    void index();
+
+    // Identifies the instance independently of its name and of edge and exclusion order
+    uint64_t hash() const;
+
+    // Cut weight of a complete assignment, infinity if a node is unassigned or an exclusion pair shares a side
+    float cut(const VSolution& solution) const;
+
 #ifdef USE_MPI
     // OpenMPI convenience functions
     void send(int dest) const;
@@ -0,0 +1,190 @@
+#include "SolutionCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "Util.hpp"
+
+namespace {
+
+constexpr const char* MAGIC = "PDPCACHE1";
+
+// Entries nearest() reads at most, the most recently written ones with the right node count
+constexpr size_t NEAREST_LIMIT = 32;
+
+// Distinguishes temporary files of writers storing the same instance at once
+std::atomic<uint64_t> writes = 0;
+
+// Entries are named after the node count first, so near matches are found without opening every file
+std::string prefix(uint32_t n) {
+    return "n" + std::to_string(n) + "-";
+}
+
+std::optional<CacheEntry> read_entry(const std::string& path, uint32_t n) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return std::nullopt;
+    }
+
+    CacheEntry entry;
+    char magic[16] = {};
+    uint64_t hash;
+    uint32_t size;
+    char variant[256] = {};
+
+    bool valid = fscanf(file, "%15s %" SCNx64 " %u", magic, &hash, &size) == 3 && strcmp(magic, MAGIC) == 0 && size == n
+        && fscanf(file, " Weight: %f", &entry.weight) == 1
+        && fscanf(file, " Solution: [") == 0;
+
+    entry.solution.resize(n);
+    for (uint32_t i = 0; valid && i < n; i++) {
+        unsigned side;
+        valid = fscanf(file, "%u", &side) == 1 && (side == 1 || side == 2);
+        entry.solution[i] = side;
+    }
+
+    valid = valid
+        && fscanf(file, "] Nodes: %" SCNu64, &entry.nodes) == 1
+        && fscanf(file, " Elapsed time: %lfs", &entry.elapsed) == 1
+        && fscanf(file, " Variant: %255[^\n]", variant) == 1;
+    entry.variant = variant;
+
+    fclose(file);
+
+    if (!valid) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+}
+
+SolutionCache::SolutionCache(std::string directory)
+    : directory(std::move(directory))
+{}
+
+std::string SolutionCache::path(const Problem& problem) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".sol", problem.hash());
+    return directory + "/" + prefix(problem.n) + name;
+}
+
+std::optional<CacheEntry> SolutionCache::lookup(const Problem& problem) const {
+    auto entry = read_entry(path(problem), problem.n);
+    if (!entry) {
+        return std::nullopt;
+    }
+
+    // A hash collision or a hand-edited file would not reproduce its own weight
+    float weight = problem.cut(entry->solution);
+    if (!std::isfinite(weight) || std::abs(weight - entry->weight) > 1e-3f * std::max(1.0f, std::abs(weight))) {
+        fprintf(stderr, "Ignoring invalid cache entry: %s\n", path(problem).c_str());
+        return std::nullopt;
+    }
+
+    return entry;
+}
+
+std::optional<CacheEntry> SolutionCache::nearest(const Problem& problem) const {
+    std::optional<CacheEntry> best;
+    if (problem.n == 0) {
+        return best;
+    }
+
+    // Only names and modification times are looked at for every entry, so a large cache stays cheap to search
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> candidates;
+
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = file.path().filename().string();
+        if (name.rfind(prefix(problem.n), 0) != 0 || file.path().extension() != ".sol") {
+            continue;
+        }
+
+        auto time = file.last_write_time(error);
+        if (!error) {
+            candidates.emplace_back(time, file.path());
+        }
+    }
+
+    size_t count = std::min(candidates.size(), NEAREST_LIMIT);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), std::greater<>());
+    candidates.resize(count);
+
+    for (const auto& [time, path] : candidates) {
+        // Sides are checked while reading, so mirroring below only ever sees 1 and 2
+        auto entry = read_entry(path.string(), problem.n);
+        if (!entry) {
+            continue;
+        }
+
+        // Node 0 is always on side 1 in the search, mirror the assignment to match
+        if (entry->solution[0] == 2) {
+            for (auto& side : entry->solution) {
+                side = Util::invert(side);
+            }
+        }
+
+        entry->weight = problem.cut(entry->solution);
+        if (std::isfinite(entry->weight) && (!best || entry->weight < best->weight)) {
+            best = std::move(entry);
+        }
+    }
+
+    return best;
+}
+
+bool SolutionCache::store(const Problem& problem, const CacheEntry& entry) const {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Write next to the target and rename, so concurrent readers never see a torn entry
+    std::string target = path(problem);
+    std::string temporary = target + "." + std::to_string(getpid()) + "-" + std::to_string(writes++) + ".tmp";
+
+    FILE* file = fopen(temporary.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write cache entry: %s\n", temporary.c_str());
+        return false;
+    }
+
+    fprintf(file, "%s %016" PRIx64 " %u\n", MAGIC, problem.hash(), problem.n);
+    fprintf(file, "Weight: %.9g\n", entry.weight);
+    fprintf(file, "Solution: [");
+    for (size_t i = 0; i < entry.solution.size(); i++) {
+        fprintf(file, i > 0 ? " %d" : "%d", entry.solution[i]);
+    }
+    fprintf(file, "]\n");
+    fprintf(file, "Nodes: %" PRIu64 "\n", entry.nodes);
+    fprintf(file, "Elapsed time: %fs\n", entry.elapsed);
+    fprintf(file, "Variant: %s\n", entry.variant.c_str());
+
+    // Write errors stick to the stream, a full disk may only show up when it is flushed or closed
+    bool written = !ferror(file) && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    written = fclose(file) == 0 && written;
+
+    // An existing entry for the instance stays in place unless the new one is complete
+    if (!written || rename(temporary.c_str(), target.c_str()) != 0) {
+        fprintf(stderr, "Cannot write cache entry: %s\n", target.c_str());
+        remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+std::unique_ptr<SolutionCache> SolutionCache::from_args(int argc, const char** argv) {
+    auto directory = Util::option(argc, argv, "cache");
+    if (!directory) {
+        return nullptr;
+    }
+
+    return std::make_unique<SolutionCache>(std::string(*directory));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "Problem.hpp"
+
+// Proven optimum of one instance and what it took to find it
+struct CacheEntry {
+    VSolution solution;
+    float weight = 0.0f;
+
+    uint64_t nodes = 0;
+    double elapsed = 0.0;
+    std::string variant;
+};
+
+// Directory of proven optima keyed by Problem::hash, one text file per instance
+class SolutionCache {
+public:
+    explicit SolutionCache(std::string directory);
+
+    // Entry for exactly this instance, ignored unless its cut weight checks out
+    std::optional<CacheEntry> lookup(const Problem& problem) const;
+
+    // Lightest feasible assignment among the most recent entries with the same node count, re-weighted
+    // for this instance, as a warm start incumbent when there is no exact entry
+    std::optional<CacheEntry> nearest(const Problem& problem) const;
+
+    // Returns false and leaves no partial entry behind when the write fails
+    bool store(const Problem& problem, const CacheEntry& entry) const;
+
+    // Reads --cache DIR
+    static std::unique_ptr<SolutionCache> from_args(int argc, const char** argv);
+
+private:
+    std::string path(const Problem& problem) const;
+
+    std::string directory;
+};
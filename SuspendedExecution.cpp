@@ -0,0 +1,72 @@
+#include "SuspendedExecution.hpp"
+
+#include <mpi.h>
+
+#include "Util.hpp"
+
+SuspendedExecution SuspendedExecution::root(const Problem& problem) {
+    SuspendedExecution result { 0, VSolution(problem.n), 0.0f };
+    result.weight = Branching::assign(problem, result.solution, 0, 1);
+    return result;
+}
+
+void SuspendedExecution::split(const Problem& problem, const Branching& branching, SuspendedExecution job, int levels, std::vector<SuspendedExecution>& out) {
+    Node node = branching.select(problem, job.solution);
+
+    if (levels <= 0 || node < 0) {
+        out.push_back(std::move(job));
+        return;
+    }
+
+    uint8_t first = branching.first(problem, job.solution, node);
+
+    for (uint8_t side : { first, (uint8_t) Util::invert(first) }) {
+        SuspendedExecution child { job.depth + 1, job.solution, job.weight };
+        child.weight += Branching::assign(problem, child.solution, node, side);
+        split(problem, branching, std::move(child), levels - 1, out);
+    }
+}
+
+#ifdef USE_MPI
+
+void SuspendedExecution::send(int dest) const {
+    MPI_Send(&this->depth, 1, MPI_INT, dest, 0, MPI_COMM_WORLD);
+
+    // Solution
+    int32_t solution_size = this->solution.size();
+    MPI_Send(&solution_size, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+
+    for (const auto& v : this->solution) {
+        MPI_Send(&v, 1, MPI_UINT8_T, dest, 0, MPI_COMM_WORLD);
+    }
+
+    MPI_Send(&this->weight, 1, MPI_FLOAT, dest, 0, MPI_COMM_WORLD);
+}
+
+std::optional<SuspendedExecution> SuspendedExecution::receive(int src) {
+    SuspendedExecution result;
+
+    MPI_Recv(&result.depth, 1, MPI_INT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    if (result.depth == -1) {
+        return std::nullopt;
+    }
+
+    // Solution
+    int32_t solution_size;
+    MPI_Recv(&solution_size, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    result.solution.resize(solution_size);
+
+    for (size_t i = 0; i < solution_size; i++) {
+        uint8_t v;
+        MPI_Recv(&v, 1, MPI_UINT8_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        result.solution[i] = v;
+    }
+
+    MPI_Recv(&result.weight, 1, MPI_FLOAT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "Branching.hpp"
+#include "Problem.hpp"
+
+// Split depth used when an engine needs job boundaries for checkpoints or progress estimates,
+// an interrupted run then only repeats the jobs that were in flight
+constexpr int SPLIT_DEPTH = 10;
+
+// Open subproblem: a partial assignment and the cut weight it already carries
+struct SuspendedExecution {
+    int depth;
+    VSolution solution;
+    float weight;
+
+    // Node 0 on side 1, which removes the mirrored half of the search space
+    static SuspendedExecution root(const Problem& problem);
+
+    // Appends the open subproblems `levels` branching decisions below `job` to `out`,
+    // complete assignments reached earlier are appended as they are
+    static void split(const Problem& problem, const Branching& branching, SuspendedExecution job, int levels, std::vector<SuspendedExecution>& out);
+
+#ifdef USE_MPI
+    // OpenMPI convenience functions, a depth of -1 marks the end of work
+    void send(int dest) const;
+    static std::optional<SuspendedExecution> receive(int src);
+#endif
+};
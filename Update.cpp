@@ -0,0 +1,331 @@
+#include "Update.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
+
+#include <mpi.h>
+
+#include "Util.hpp"
+
+namespace {
+
+std::pair<Node, Node> ordered(Node a, Node b) {
+    return { std::min(a, b), std::max(a, b) };
+}
+
+[[noreturn]] void invalid(const std::string& path, const char* reason) {
+    fprintf(stderr, "Invalid %s: %s\n", reason, path.c_str());
+    exit(EXIT_FAILURE);
+}
+
+// Contents of a --previous file that matter for the re-solve
+struct Previous {
+    VSolution solution;
+    std::optional<uint64_t> hash;
+    bool optimal = false;
+};
+
+// First `Solution: [...]` line of the file, and whether the file proves it optimal: cache entries only
+// hold proven optima, engine output does once it says `Status: optimal`. Both name the instance by hash.
+Previous read_previous(const std::string& path, uint32_t n) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        invalid(path, "previous solution");
+    }
+
+    Previous previous;
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        const char* rest = line;
+
+        if (strncmp(rest, "PDPCACHE1 ", 10) == 0) {
+            previous.hash = strtoull(rest + 10, nullptr, 16);
+            previous.optimal = true;
+            continue;
+        }
+        if (strncmp(rest, "Instance: ", 10) == 0 && !previous.hash) {
+            previous.hash = strtoull(rest + 10, nullptr, 16);
+            continue;
+        }
+        if (strcmp(rest, "Status: optimal\n") == 0) {
+            previous.optimal = true;
+            continue;
+        }
+        if (strncmp(rest, "Solution: [", 11) != 0 || !previous.solution.empty()) {
+            continue;
+        }
+
+        rest += 11;
+        char* end;
+        for (long side = strtol(rest, &end, 10); end != rest; side = strtol(rest, &end, 10)) {
+            previous.solution.push_back(side);
+            rest = end;
+        }
+    }
+
+    fclose(file);
+
+    if (previous.solution.size() != n) {
+        invalid(path, "previous solution");
+    }
+    return previous;
+}
+}
+
+Delta Delta::read(const std::string& path, uint32_t n) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        invalid(path, "delta");
+    }
+
+    Delta delta;
+    char kind[16];
+    Node a, b;
+
+    // Nodes index the instance's adjacency and exclusion tables
+    auto node = [&](Node v) {
+        return v >= 0 && (uint32_t) v < n;
+    };
+
+    int fields;
+    while ((fields = fscanf(file, "%15s %d %d", kind, &a, &b)) == 3) {
+        if (!node(a) || !node(b) || a == b) {
+            invalid(path, "delta");
+        }
+
+        if (strcmp(kind, "edge") == 0) {
+            float v;
+            if (fscanf(file, "%f", &v) != 1 || !(v >= 0.0f) || std::isinf(v)) {
+                invalid(path, "delta");
+            }
+            delta.edges.emplace_back(a, b, v);
+        }
+        else if (strcmp(kind, "exclude") == 0) {
+            delta.excluded.emplace_back(a, b);
+        }
+        else if (strcmp(kind, "allow") == 0) {
+            delta.allowed.emplace_back(a, b);
+        }
+        else {
+            invalid(path, "delta");
+        }
+    }
+
+    // Anything but the end of the file stopped the loop, a truncated or malformed line
+    fclose(file);
+    if (fields != EOF) {
+        invalid(path, "delta");
+    }
+    return delta;
+}
+
+Problem Delta::apply(const Problem& base) const {
+    Problem result;
+    result.name = base.name;
+    result.n = base.n;
+    result.k = base.k;
+
+    std::map<std::pair<Node, Node>, float> weights;
+    for (auto [a, b, v] : base.edges) {
+        weights[ordered(a, b)] = v;
+    }
+    for (auto [a, b, v] : edges) {
+        if (v == 0.0f) {
+            weights.erase(ordered(a, b));
+        }
+        else {
+            weights[ordered(a, b)] = v;
+        }
+    }
+    for (auto [edge, v] : weights) {
+        result.edges.emplace_back(edge.first, edge.second, v);
+    }
+
+    std::map<Node, Node> pairs;
+    for (auto [a, b] : base.exclusions) {
+        pairs[std::min(a, b)] = std::max(a, b);
+    }
+    for (auto [a, b] : allowed) {
+        pairs.erase(std::min(a, b));
+    }
+    for (auto [a, b] : excluded) {
+        pairs[std::min(a, b)] = std::max(a, b);
+    }
+
+    // Exclusion pairs have to stay disjoint
+    std::vector<bool> paired(result.n);
+    for (auto [a, b] : pairs) {
+        if (paired[a] || paired[b]) {
+            fprintf(stderr, "Invalid delta: node in two exclusion pairs\n");
+            exit(EXIT_FAILURE);
+        }
+        paired[a] = paired[b] = true;
+        result.exclusions[a] = b;
+    }
+    result.b = result.exclusions.size();
+
+    result.index();
+    return result;
+}
+
+std::optional<ShiftBound> Delta::shift(const Problem& base, float optimum) const {
+    if (!allowed.empty()) {
+        return std::nullopt;
+    }
+
+    std::map<std::pair<Node, Node>, float> weights;
+    for (auto [a, b, v] : base.edges) {
+        weights[ordered(a, b)] = v;
+    }
+
+    // Later changes of the same edge override earlier ones
+    std::map<std::pair<Node, Node>, float> changed;
+    for (auto [a, b, v] : edges) {
+        changed[ordered(a, b)] = v;
+    }
+
+    ShiftBound result { optimum, {} };
+    for (auto [edge, v] : changed) {
+        auto old = weights.find(edge);
+        result.changes.emplace_back(edge.first, edge.second, v - (old == weights.end() ? 0.0f : old->second));
+    }
+    return result;
+}
+
+std::optional<Update> Update::from_args(const Problem& base, int argc, const char** argv) {
+    auto delta_path = Util::option(argc, argv, "delta");
+    auto previous_path = Util::option(argc, argv, "previous");
+    if (!delta_path || !previous_path) {
+        return std::nullopt;
+    }
+
+    Delta delta = Delta::read(std::string(*delta_path), base.n);
+    Previous previous = read_previous(std::string(*previous_path), base.n);
+
+    float optimum = base.cut(previous.solution);
+    if (!std::isfinite(optimum)) {
+        invalid(std::string(*previous_path), "previous solution");
+    }
+
+    Update result { delta.apply(base), previous.solution, 0.0f, {}, std::nullopt, 0.0f };
+
+    // Weight added by moving a single node to the other side
+    auto flip_cost = [&](Node node) {
+        float added = 0.0f;
+        for (auto [m, v] : result.problem.adjacency[node]) {
+            added += result.incumbent[m] == result.incumbent[node] ? v : -v;
+        }
+        return added;
+    };
+
+    // New exclusion pairs sharing a side, move whichever node of the pair adds less weight
+    for (auto [a, b] : result.problem.exclusions) {
+        if (result.incumbent[a] == result.incumbent[b]) {
+            Node moved = flip_cost(a) <= flip_cost(b) ? a : b;
+            result.incumbent[moved] = Util::invert(result.incumbent[moved]);
+        }
+    }
+
+    // Node 0 is always on side 1 in the search
+    if (result.incumbent[0] == 2) {
+        for (auto& side : result.incumbent) {
+            side = Util::invert(side);
+        }
+    }
+
+    result.weight = result.problem.cut(result.incumbent);
+    for (auto [a, b, v] : delta.edges) {
+        result.touched.push_back(a);
+        result.touched.push_back(b);
+    }
+
+    // A bound from anything but the base optimum would prune the real optimum of the update
+    if (previous.optimal && previous.hash == base.hash()) {
+        result.shift = delta.shift(base, optimum);
+    }
+    else {
+        fprintf(stderr, "Previous solution not proven optimal for %s, used only as an incumbent\n", base.name.c_str());
+    }
+    result.lower_bound = result.shift ? std::max(0.0f, result.shift->at(VSolution(base.n))) : 0.0f;
+
+    return result;
+}
+
+#ifdef USE_MPI
+
+void Update::send(const std::optional<Update>& update, int dest) {
+    uint8_t present = update.has_value();
+    MPI_Send(&present, 1, MPI_UINT8_T, dest, 0, MPI_COMM_WORLD);
+
+    if (!update) {
+        return;
+    }
+
+    int32_t touched_size = update->touched.size();
+    MPI_Send(&touched_size, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+    MPI_Send(update->touched.data(), touched_size, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+
+    // Shift bound, -1 changes when there is none
+    int32_t changes_size = update->shift ? update->shift->changes.size() : -1;
+    float base = update->shift ? update->shift->base : 0.0f;
+    MPI_Send(&changes_size, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+    MPI_Send(&base, 1, MPI_FLOAT, dest, 0, MPI_COMM_WORLD);
+
+    for (int32_t i = 0; i < changes_size; i++) {
+        const auto& [a, b, delta] = update->shift->changes[i];
+        MPI_Send(&a, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+        MPI_Send(&b, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+        MPI_Send(&delta, 1, MPI_FLOAT, dest, 0, MPI_COMM_WORLD);
+    }
+
+    MPI_Send(&update->lower_bound, 1, MPI_FLOAT, dest, 0, MPI_COMM_WORLD);
+}
+
+std::optional<Update> Update::receive(int src, const Problem& problem) {
+    uint8_t present;
+    MPI_Recv(&present, 1, MPI_UINT8_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    if (!present) {
+        return std::nullopt;
+    }
+
+    Update result { problem, {}, std::numeric_limits<float>::infinity(), {}, std::nullopt, 0.0f };
+
+    int32_t touched_size;
+    MPI_Recv(&touched_size, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    result.touched.resize(touched_size);
+    MPI_Recv(result.touched.data(), touched_size, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    int32_t changes_size;
+    float base;
+    MPI_Recv(&changes_size, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Recv(&base, 1, MPI_FLOAT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    if (changes_size >= 0) {
+        result.shift = ShiftBound { base, {} };
+    }
+
+    for (int32_t i = 0; i < changes_size; i++) {
+        Node a;
+        Node b;
+        float delta;
+
+        MPI_Recv(&a, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(&b, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(&delta, 1, MPI_FLOAT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+        result.shift->changes.emplace_back(a, b, delta);
+    }
+
+    MPI_Recv(&result.lower_bound, 1, MPI_FLOAT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Bounds.hpp"
+#include "Problem.hpp"
+
+// Changes between two versions of an instance, one per line of a text file:
+//   edge A B WEIGHT   sets the weight of edge A-B, 0 removes it
+//   exclude A B       adds the exclusion pair A-B
+//   allow A B         removes the exclusion pair A-B
+struct Delta {
+    std::vector<Edge> edges;
+    std::vector<std::pair<Node, Node>> excluded;
+    std::vector<std::pair<Node, Node>> allowed;
+
+    // Exits on a malformed line, a negative weight or a node outside the `n` nodes of the base instance
+    static Delta read(const std::string& path, uint32_t n);
+
+    Problem apply(const Problem& base) const;
+
+    // Per assignment bound from the base optimum, none once an exclusion is allowed
+    // since the base search never considered those assignments
+    std::optional<ShiftBound> shift(const Problem& base, float optimum) const;
+};
+
+// Re-solve of a base instance after a delta, starting from the base optimum
+struct Update {
+    // Base instance with the delta applied
+    Problem problem;
+
+    // Previous assignment, repaired for new exclusions and weighed under the new edges
+    VSolution incumbent;
+    float weight;
+
+    // Endpoints of the changed edges, branched on first so the shift bound applies early
+    std::vector<Node> touched;
+
+    // Bound on the updated instance derived from the base optimum
+    std::optional<ShiftBound> shift;
+
+    // Base optimum minus every weight decrease, no solution of the updated instance weighs less
+    float lower_bound;
+
+    // Reads --delta PATH and --previous PATH. The previous file holds a base solution on a `Solution: [...]`
+    // line, as printed by every engine and kept in cache entries. It only bounds the search when the file
+    // proves it the base optimum, a cache entry or optimal engine output for the same instance hash.
+    static std::optional<Update> from_args(const Problem& base, int argc, const char** argv);
+
+#ifdef USE_MPI
+    // OpenMPI convenience functions, workers get the changed edge endpoints and the shift bound
+    // for the problem they already received, but no incumbent
+    static void send(const std::optional<Update>& update, int dest);
+    static std::optional<Update> receive(int src, const Problem& problem);
+#endif
+};
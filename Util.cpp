@@ -1,6 +1,8 @@
 #include "Util.hpp"
 
 #include <cassert>
+#include <charconv>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 
@@ -35,6 +37,48 @@ int32_t Util::invert(int32_t group) {
 }
 
 void Util::print_usage_and_exit(int argc, const char **argv) {
-    fprintf(stderr, "Usage: %s PROBLEM", argv[0]);
+    fprintf(stderr, "Usage: %s PROBLEM [--branching static|difference|neighbours] [--values static|cheapest] [--seed N] [--checkpoint PATH] [--checkpoint-interval SECONDS] [--resume PATH] [--cache DIR] [--delta PATH --previous PATH] [--flow-depth D] [--time-limit SECONDS] [--progress SECONDS] [--json]\n", argv[0]);
     exit(EXIT_FAILURE);
 }
+
+std::optional<std::string_view> Util::option(int argc, const char **argv, std::string_view name) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+
+        if (!arg.starts_with("--") || arg.substr(2, name.size()) != name) {
+            continue;
+        }
+
+        auto rest = arg.substr(2 + name.size());
+        if (rest.empty()) {
+            return i + 1 < argc ? std::optional<std::string_view>(argv[i + 1]) : std::string_view();
+        }
+        if (rest.front() == '=') {
+            return rest.substr(1);
+        }
+    }
+
+    return std::nullopt;
+}
+
+template <typename T>
+std::optional<T> Util::number(int argc, const char **argv, std::string_view name, T minimum) {
+    auto text = option(argc, argv, name);
+    if (!text) {
+        return std::nullopt;
+    }
+
+    T value {};
+    auto [end, error] = std::from_chars(text->data(), text->data() + text->size(), value);
+
+    bool valid = !text->empty() && error == std::errc() && end == text->data() + text->size()
+        && std::isfinite((double) value) && value >= minimum;
+    if (!valid) {
+        fprintf(stderr, "Invalid --%.*s: %.*s\n", (int) name.size(), name.data(), (int) text->size(), text->data());
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+template std::optional<int> Util::number(int argc, const char **argv, std::string_view name, int minimum);
+template std::optional<double> Util::number(int argc, const char **argv, std::string_view name, double minimum);
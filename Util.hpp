@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #define timed Timer() + [&]()
@@ -23,4 +25,11 @@ void printf_solution(const char* title, uint64_t value, int n);
 namespace Util {
     int32_t invert(int32_t group);
     void print_usage_and_exit(int argc, const char** argv);
-}
\ No newline at end of file
+
+    // Looks up `--name VALUE` or `--name=VALUE` in the command line
+    std::optional<std::string_view> option(int argc, const char** argv, std::string_view name);
+
+    // Value of `--name` read as a whole number of type T (int or double), exits on anything else or on less than `minimum`
+    template <typename T>
+    std::optional<T> number(int argc, const char** argv, std::string_view name, T minimum);
+}
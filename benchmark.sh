@@ -0,0 +1,53 @@
+#!/usr/bin/env bash
+# Compares branching policies on the given instances
+#
+# Usage: ./benchmark.sh BUILD_DIR PROBLEM...
+#
+# With SERVICE_THREADS set, the instances are also pushed SERVICE_REPEAT times
+# through one service process split into SERVICE_GROUPS groups, and its throughput is reported.
+
+set -euo pipefail
+
+BUILD=${1:?Usage: $0 BUILD_DIR PROBLEM...}
+shift
+
+VARIABLES=${VARIABLES:-"static difference neighbours"}
+VALUES=${VALUES:-"static cheapest"}
+
+field() {
+    grep "^$1:" | sed "s/^$1: //"
+}
+
+printf "%-28s %-22s %12s %14s %12s\n" "Problem" "Branching" "Weight" "Nodes" "Time"
+
+for problem in "$@"; do
+    for variable in $VARIABLES; do
+        for value in $VALUES; do
+            output=$("$BUILD/sequential" "$problem" --branching "$variable" --values "$value")
+
+            printf "%-28s %-22s %12s %14s %12s\n" \
+                "$(basename "$problem")" \
+                "$(field Branching <<< "$output")" \
+                "$(field Weight <<< "$output")" \
+                "$(field Nodes <<< "$output")" \
+                "$(field "Elapsed time" <<< "$output")"
+        done
+    done
+done
+
+if [[ -n "${SERVICE_THREADS:-}" ]]; then
+    SERVICE_GROUPS=${SERVICE_GROUPS:-1}
+    SERVICE_REPEAT=${SERVICE_REPEAT:-10}
+
+    summary=$(for _ in $(seq "$SERVICE_REPEAT"); do printf "%s\n" "$@"; done \
+        | "$BUILD/service" "$SERVICE_THREADS" --groups "$SERVICE_GROUPS" 2>&1 >/dev/null)
+
+    echo
+    printf "%-10s %-8s %12s %12s %16s\n" "Threads" "Groups" "Instances" "Time" "Instances/s"
+    printf "%-10s %-8s %12s %12s %16s\n" \
+        "$SERVICE_THREADS" \
+        "$SERVICE_GROUPS" \
+        "$(field Served <<< "$summary" | cut -d' ' -f1)" \
+        "$(field "Elapsed time" <<< "$summary")" \
+        "$(field Throughput <<< "$summary" | cut -d' ' -f1)"
+fi
@@ -1,24 +1,29 @@
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <cstdint>
 #include <cmath>
+#include <memory>
 
 #include <string_view>
 
 #include <omp.h>
 
+#include "Affinity.hpp"
+#include "Anytime.hpp"
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Checkpoint.hpp"
 #include "Problem.hpp"
+#include "SolutionCache.hpp"
+#include "SuspendedExecution.hpp"
+#include "Update.hpp"
 #include "Util.hpp"
 
-using VSolution = std::vector<uint8_t>;
-
-struct SuspendedExecution {
-    int pos;
-    VSolution solution;
-    float weight;
-};
-
 Problem problem;
+Branching branching;
+Bounding bounding;
+Anytime anytime;
 
 VSolution bestSolution;
 float bestWeight = std::numeric_limits<float>::infinity();
@@ -26,29 +31,27 @@ float bestWeight = std::numeric_limits<float>::infinity();
 int maxDepth = 0;
 std::vector<SuspendedExecution> suspensions;
 
-void partial_solve(int pos, VSolution solution, float weight, int depth) {
-    assert(pos > 0);
+uint64_t nodes = 0;
+#pragma omp threadprivate(nodes)
 
-    // Satisfy exclusions
-    if (problem.exclusions.count(pos - 1) > 0) {
-        solution[problem.exclusions.at(pos - 1)] = Util::invert(solution[pos - 1]);
-    }
+// Search data on the calling thread's socket, only built when --affinity pins threads
+std::vector<std::unique_ptr<Replica>> replicas;
+Replica* local = nullptr;
+#pragma omp threadprivate(local)
 
-    // Calculate the weight
-    for (auto [a, b, v] : problem.edges) {
-        if (b == pos - 1 && solution[a] != solution[b]) {
-            weight += v;
-        }
-    }
+void partial_solve(VSolution solution, float weight, int depth) {
+    nodes++;
 
     // Can't do better
     if (bestWeight < weight) {
         return;
     }
 
-    if (pos == problem.n) {
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
         if (bestWeight > weight) {
-#pragma omp critical
+            #pragma omp critical
             {
                 if (bestWeight > weight) {
                     bestSolution = solution;
@@ -59,116 +62,287 @@ void partial_solve(int pos, VSolution solution, float weight, int depth) {
         return;
     }
 
-    // Value already set
-    if (solution[pos] != 0) {
-        partial_solve(pos + 1, std::move(solution), weight, depth);
-        return;
-    }
+    uint8_t first = branching.first(problem, solution, node);
 
-    if (depth >= maxDepth) {
-        solution[pos] = 1;
-        suspensions.push_back({ pos + 1, solution, weight });
-
-        solution[pos] = 2;
-        suspensions.push_back({ pos + 1, std::move(solution), weight });
-    }
-    else {
-        // Recurse
-        solution[pos] = 1;
-        partial_solve(pos + 1, solution, weight, depth + 1);
+    for (uint8_t side : { first, (uint8_t) Util::invert(first) }) {
+        VSolution child = solution;
+        float added = Branching::assign(problem, child, node, side);
 
-        solution[pos] = 2;
-        partial_solve(pos + 1, std::move(solution), weight, depth + 1);
+        if (depth >= maxDepth) {
+            suspensions.push_back({ depth + 1, std::move(child), weight + added });
+        }
+        else {
+            partial_solve(std::move(child), weight + added, depth + 1);
+        }
     }
 }
 
-void solve(int pos, VSolution solution, float weight) {
-    assert(pos > 0);
+// Pinned threads search their socket's replica, unpinned runs read the globals exactly as before
+template <bool Pinned>
+void solve(VSolution solution, float weight, float bound, int depth) {
+    nodes++;
 
-    // Satisfy exclusions
-    if (problem.exclusions.count(pos - 1) > 0) {
-        solution[problem.exclusions.at(pos - 1)] = Util::invert(solution[pos - 1]);
+    const Problem& problem = Pinned ? local->problem : ::problem;
+    const Branching& branching = Pinned ? local->branching : ::branching;
+    const Bounding& bounding = Pinned ? local->bounding : ::bounding;
+    float& incumbent = Pinned ? local->bestWeight : bestWeight;
+
+    // Out of time
+    if (anytime.cancelled(nodes)) {
+        return;
     }
 
-    // Calculate the weight
-    for (auto [a, b, v] : problem.edges) {
-        if (b == pos - 1 && solution[a] != solution[b]) {
-            weight += v;
-        }
+    if (Pinned && (nodes & (Replica::REFRESH - 1)) == 0 && bestWeight < incumbent) {
+        incumbent = bestWeight;
     }
 
     // Can't do better
-    if (bestWeight < weight) {
+    if (incumbent < weight) {
         return;
     }
 
-    if (pos == problem.n) {
-        if (bestWeight > weight) {
+    bound = bounding.tighten(solution, weight, bound, depth);
+    if (incumbent <= bound) {
+        return;
+    }
+
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
+        if (incumbent > weight) {
             #pragma omp critical
             {
                 if (bestWeight > weight) {
                     bestSolution = solution;
                     bestWeight = weight;
                 }
+                if (Pinned) {
+                    incumbent = bestWeight;
+                }
             }
         }
         return;
     }
 
-    // Value already set
-    if (solution[pos] != 0) {
-        return solve(pos + 1, std::move(solution), weight);
-    }
+    uint8_t first = branching.first(problem, solution, node);
 
     // Recurse
-    solution[pos] = 1;
-    solve(pos + 1, solution, weight);
+    VSolution child = solution;
+    float added = Branching::assign(problem, child, node, first);
+    solve<Pinned>(std::move(child), weight + added, bound, depth + 1);
 
-    solution[pos] = 2;
-    solve(pos + 1, std::move(solution), weight);
+    added = Branching::assign(problem, solution, node, Util::invert(first));
+    solve<Pinned>(std::move(solution), weight + added, bound, depth + 1);
 }
 
 int main(int argc, const char** argv) {
     // Override thread count
     if (argc < 3) {
-        printf("USAGE: ./data PROBLEM THREADS");
+        printf("USAGE: ./data PROBLEM THREADS [--branching static|difference|neighbours] [--values static|cheapest] [--seed N] [--checkpoint PATH] [--checkpoint-interval SECONDS] [--resume PATH] [--cache DIR] [--delta PATH --previous PATH] [--flow-depth D] [--affinity numa|CORES:CORES...] [--time-limit SECONDS] [--progress SECONDS] [--json]");
         exit(EXIT_FAILURE);
     }
 
     int num_threads = std::stoi(argv[2]);
     omp_set_dynamic(0);
     omp_set_num_threads(num_threads);
+    auto affinity = Affinity::from_args(argc, argv);
 
-    maxDepth = log2(omp_get_num_threads()) + 1;
+    // Outside a parallel region omp_get_num_threads() is always 1
+    maxDepth = log2(std::max(num_threads, 1)) + 1;
 
     // Load data
     problem = Problem::load(argc, argv);
+    branching = Branching::from_args(problem, argc, argv);
+
+    // Re-solve after a delta: branch on the changed edges first and bound by the base optimum
+    auto update = Update::from_args(problem, argc, argv);
+    if (update) {
+        problem = update->problem;
+        branching = branching.prioritize(update->touched);
+    }
+    bounding = Bounding::from_args(problem, argc, argv);
+    bounding.shift = update ? update->shift : std::nullopt;
+
+    anytime = Anytime::from_args(argc, argv);
+
+    auto resumed = Checkpoint::from_args(problem, argc, argv);
+    auto checkpoints = CheckpointWriter::from_args(problem, argc, argv);
+
+    auto cache = SolutionCache::from_args(argc, argv);
+    auto cached = cache ? cache->lookup(problem) : std::nullopt;
+
+    // Find partial solutions, or pick up the ones left in the checkpoint
+    Checkpoint previous = resumed.value_or(Checkpoint {});
+
+    if (cached) {
+        // Proven optimum on disk, nothing left to search
+        bestSolution = cached->solution;
+        bestWeight = cached->weight;
+    }
+    else if (resumed) {
+        suspensions = std::move(previous.jobs);
+        bestSolution = previous.bestSolution;
+        bestWeight = previous.bestWeight;
+    }
+    else {
+        // Finer jobs to checkpoint or estimate progress between, and at least one per pinned thread
+        if (checkpoints || anytime.enabled() || affinity) {
+            maxDepth = std::max(maxDepth, SPLIT_DEPTH);
+        }
 
-    // Find partial solutions
-    VSolution solution;
-    solution.resize(problem.n);
-    solution[0] = 1;
+        auto root = SuspendedExecution::root(problem);
+        partial_solve(std::move(root.solution), root.weight, 0);
+    }
+
+    // A cached near match starts the search with an incumbent
+    auto warm = cache && !cached ? cache->nearest(problem) : std::nullopt;
+    if (warm && warm->weight < bestWeight) {
+        bestSolution = warm->solution;
+        bestWeight = warm->weight;
+    }
+    else {
+        warm.reset();
+    }
+
+    // The previous optimum, and a search only as far as the bound shift leaves open
+    if (update && update->weight < bestWeight) {
+        bestSolution = update->incumbent;
+        bestWeight = update->weight;
+    }
+    if (update && bestWeight <= update->lower_bound) {
+        suspensions.clear();
+    }
 
-    partial_solve(1, std::move(solution), 0.0f, 0);
+    std::vector<std::atomic<bool>> finished(suspensions.size());
+    std::atomic<size_t> finished_count = 0;
+    std::atomic<uint64_t> flushed_nodes = previous.nodes;
+
+    auto open_jobs = [&]() {
+        std::vector<SuspendedExecution> result;
+        for (size_t i = 0; i < suspensions.size(); i++) {
+            if (!finished[i]) {
+                result.push_back(suspensions[i]);
+            }
+        }
+        return result;
+    };
+
+    // The lightest open job bounds every solution still to be found, and so does the root flow bound
+    auto root = SuspendedExecution::root(problem);
+    float root_bound = bounding.tighten(root.solution, root.weight, root.weight, root.depth);
+
+    auto lower_bound = [&]() {
+        float bound = bestWeight;
+        for (size_t i = 0; i < suspensions.size(); i++) {
+            if (!finished[i]) {
+                bound = std::min(bound, suspensions[i].weight);
+            }
+        }
+        return std::min(bestWeight, std::max(bound, root_bound));
+    };
+
+    anytime.status = [&]() {
+        return Anytime::Status { bestWeight, lower_bound(), suspensions.size() - finished_count, suspensions.size() };
+    };
 
     // Solve problem
+    uint64_t total_nodes = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    anytime.start();
+
+    auto run = [&](size_t i) {
+        if (affinity) {
+            solve<true>(suspensions[i].solution, suspensions[i].weight, suspensions[i].weight, suspensions[i].depth);
+        }
+        else {
+            solve<false>(suspensions[i].solution, suspensions[i].weight, suspensions[i].weight, suspensions[i].depth);
+        }
+
+        if (!anytime.cancelled()) {
+            finished[i] = true;
+            finished_count++;
+        }
+
+        if (checkpoints) {
+            flushed_nodes += nodes;
+            nodes = 0;
+        }
+
+        if (checkpoints && checkpoints->due()) {
+            #pragma omp critical
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+                checkpoints->save({ bestSolution, bestWeight, flushed_nodes, previous.elapsed + elapsed.count(), open_jobs() });
+            }
+        }
+    };
+
+    replicas.resize(affinity ? affinity->sockets(num_threads) : 0);
+    SocketQueues queues(suspensions.size(), replicas.size());
+
     auto elapsed_time = timed {
-        #pragma omp parallel
+        #pragma omp parallel reduction(+:total_nodes)
         {
-            #pragma omp for schedule(dynamic)
-            for (size_t i = 0; i < suspensions.size(); i++) {
-                solve(suspensions[i].pos, std::move(suspensions[i].solution), suspensions[i].weight);
+            if (affinity) {
+                // Pinned threads copy the search data onto their own socket before searching
+                int socket = affinity->pin(omp_get_thread_num(), num_threads);
+                if (omp_get_thread_num() < (int) replicas.size()) {
+                    replicas[socket] = std::make_unique<Replica>(problem, branching, bounding, bestWeight);
+                }
+                #pragma omp barrier
+                local = replicas[socket].get();
+
+                while (auto i = queues.next(socket)) {
+                    run(*i);
+                }
+            }
+            else {
+                #pragma omp for schedule(dynamic)
+                for (size_t i = 0; i < suspensions.size(); i++) {
+                    run(i);
+                }
             }
+
+            total_nodes += nodes;
         }
+
+        total_nodes += flushed_nodes;
     };
 
+    if (checkpoints) {
+        checkpoints->save({ bestSolution, bestWeight, total_nodes, previous.elapsed + elapsed_time.count(), open_jobs() });
+    }
+
     // Print results
     printf("Variant: Data parallelism\n");
     printf("Problem: %s\n", problem.name.c_str());
     printf("Threads: %d\n", num_threads);
+    if (affinity) {
+        printf("Affinity: %zu NUMA nodes, %lu cross-socket steals\n", replicas.size(), queues.steals());
+    }
+    printf("Branching: %s\n", branching.name().c_str());
     printf_vector("Solution", bestSolution);
     printf("Weight: %f\n", bestWeight);
+    anytime.print_result(bestWeight, lower_bound(), problem.hash());
+    if (resumed) {
+        printf("Resumed: %zu jobs, %lu nodes, %fs before\n", suspensions.size(), previous.nodes, previous.elapsed);
+    }
+    if (update) {
+        printf("Update: previous solution reweighed to %f, lower bound %f\n", update->weight, update->lower_bound);
+    }
+    if (cached) {
+        printf("Cache: hit, solved by %s in %lu nodes, %fs\n", cached->variant.c_str(), cached->nodes, cached->elapsed);
+    }
+    else if (warm) {
+        printf("Cache: warm start at %f\n", warm->weight);
+    }
+    printf("Nodes: %lu\n", total_nodes);
     printf("Elapsed time: %3fs\n", elapsed_time.count());
 
+    // Only proven optima go into the cache
+    if (cache && !cached && !anytime.cancelled()) {
+        cache->store(problem, { bestSolution, bestWeight, total_nodes, previous.elapsed + elapsed_time.count(), "Data parallelism" });
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Problem.hpp"
+#include "Util.hpp"
+
+// Synthetic instances in the text format of data/, the same seed always gives the same file
+struct Generator {
+    uint32_t n;
+    uint32_t k;
+    uint32_t b;
+
+    std::string_view weights = "uniform";
+    std::string_view exclusions = "random";
+    bool planted = false;
+
+    std::mt19937 random;
+
+    // Weights are kept at the four decimals the file holds, so the planted weight is exact
+    static float round(float value) {
+        return std::floor(value * 10000.0f + 0.5f) / 10000.0f;
+    }
+
+    float weight() {
+        if (weights == "uniform") {
+            // Same range as the bundled instances
+            return round(std::uniform_real_distribution<float>(0.1f, 1.0f)(random));
+        }
+        if (weights == "normal") {
+            return round(std::clamp(std::normal_distribution<float>(0.55f, 0.15f)(random), 0.1f, 1.0f));
+        }
+        if (weights == "integer") {
+            return std::uniform_int_distribution<int>(1, 10)(random);
+        }
+
+        fprintf(stderr, "Unknown weight distribution: %.*s\n", (int) weights.size(), weights.data());
+        exit(EXIT_FAILURE);
+    }
+
+    // Instance and, when planted, its unique optimum
+    std::pair<Problem, VSolution> generate() {
+        Problem problem;
+        problem.n = n;
+        problem.k = k;
+        problem.b = b;
+
+        uint32_t m = n * k / 2;
+        if (n < 2 || m > n * (n - 1) / 2 || 2 * b > n || (planted && (m < n - 2 || b == 0))) {
+            fprintf(stderr, "Impossible instance: n=%u k=%u b=%u%s\n", n, k, b, planted ? " planted" : "");
+            exit(EXIT_FAILURE);
+        }
+
+        // Hidden sides, node 0 on side 1 like every solver output
+        VSolution sides(n);
+        if (planted) {
+            std::vector<Node> nodes(n - 1);
+            std::iota(nodes.begin(), nodes.end(), 1);
+            std::shuffle(nodes.begin(), nodes.end(), random);
+
+            sides[0] = 1;
+            for (uint32_t i = 0; i < nodes.size(); i++) {
+                sides[nodes[i]] = i < n / 2 - 1 ? 1 : 2;
+            }
+        }
+
+        std::set<std::pair<Node, Node>> edges;
+        auto add = [&](Node a, Node c) {
+            return a != c && edges.emplace(std::min(a, c), std::max(a, c)).second;
+        };
+
+        // A random spanning tree inside each hidden side keeps the sides connected
+        if (planted) {
+            for (uint8_t side : { 1, 2 }) {
+                std::vector<Node> members;
+                for (Node i = 0; i < n; i++) {
+                    if (sides[i] == side) {
+                        members.push_back(i);
+                    }
+                }
+                std::shuffle(members.begin(), members.end(), random);
+                for (uint32_t i = 1; i < members.size(); i++) {
+                    add(members[i], members[std::uniform_int_distribution<uint32_t>(0, i - 1)(random)]);
+                }
+            }
+        }
+
+        std::uniform_int_distribution<Node> node(0, n - 1);
+        while (edges.size() < m) {
+            add(node(random), node(random));
+        }
+
+        // Edges inside a hidden side outweigh all crossing edges together, so no other
+        // separation of the exclusion pairs can be as light as the hidden one
+        float lightest = std::numeric_limits<float>::infinity();
+        std::vector<float> values;
+        for (auto [a, c] : edges) {
+            values.push_back(weight());
+            if (sides[a] == sides[c]) {
+                lightest = std::min(lightest, values.back());
+            }
+        }
+
+        if (planted) {
+            float crossing = 0.0f;
+            size_t i = 0;
+            for (auto [a, c] : edges) {
+                crossing += sides[a] != sides[c] ? values[i] : 0.0f;
+                i++;
+            }
+
+            float scale = 0.5f * lightest / std::max(crossing, 1e-6f);
+            crossing = 0.0f;
+
+            i = 0;
+            for (auto [a, c] : edges) {
+                if (sides[a] != sides[c]) {
+                    values[i] = std::max(0.0001f, std::floor(values[i] * scale * 10000.0f) / 10000.0f);
+                    crossing += values[i];
+                }
+                i++;
+            }
+
+            if (crossing >= lightest) {
+                fprintf(stderr, "Too many crossing edges to plant an optimum: n=%u k=%u\n", n, k);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        size_t i = 0;
+        for (auto [a, c] : edges) {
+            problem.edges.emplace_back(a, c, values[i++]);
+        }
+
+        // Exclusion pairs form a matching, planted ones always cross the hidden sides
+        std::vector<std::pair<Node, Node>> candidates;
+        if (exclusions == "adjacent") {
+            candidates.assign(edges.begin(), edges.end());
+        }
+        else if (exclusions == "random" || exclusions == "distant") {
+            for (Node a = 0; a < n; a++) {
+                for (Node c = a + 1; c < n; c++) {
+                    if (exclusions == "random" || !edges.count({ a, c })) {
+                        candidates.emplace_back(a, c);
+                    }
+                }
+            }
+        }
+        else {
+            fprintf(stderr, "Unknown exclusion structure: %.*s\n", (int) exclusions.size(), exclusions.data());
+            exit(EXIT_FAILURE);
+        }
+        std::shuffle(candidates.begin(), candidates.end(), random);
+
+        std::vector<bool> paired(n);
+        for (auto [a, c] : candidates) {
+            if (problem.exclusions.size() == b) {
+                break;
+            }
+            if (paired[a] || paired[c] || (planted && sides[a] == sides[c])) {
+                continue;
+            }
+            paired[a] = paired[c] = true;
+            problem.exclusions[a] = c;
+        }
+
+        if (problem.exclusions.size() < b) {
+            fprintf(stderr, "Not enough %.*s exclusion pairs: b=%u\n", (int) exclusions.size(), exclusions.data(), b);
+            exit(EXIT_FAILURE);
+        }
+
+        problem.index();
+        return { problem, planted ? sides : VSolution {} };
+    }
+};
+
+void write(FILE* file, const Problem& problem) {
+    fprintf(file, "%u %u %u\n", problem.n, problem.k, problem.b);
+    for (auto [a, c, v] : problem.edges) {
+        fprintf(file, "%4d %4d %8.4f\n", a, c, v);
+    }
+
+    // Sorted, so the file only depends on the seed
+    std::vector<std::pair<Node, Node>> pairs(problem.exclusions.begin(), problem.exclusions.end());
+    std::sort(pairs.begin(), pairs.end());
+    for (auto [a, c] : pairs) {
+        fprintf(file, "%d %d\n", a, c);
+    }
+}
+
+int main(int argc, const char** argv) {
+    if (argc < 4) {
+        printf("USAGE: ./generator N K B [--seed S] [--weights uniform|normal|integer] [--exclusions random|adjacent|distant] [--planted] [--output DIR]");
+        exit(EXIT_FAILURE);
+    }
+
+    auto seed = Util::option(argc, argv, "seed");
+
+    Generator generator {
+        (uint32_t) std::stoul(argv[1]),
+        (uint32_t) std::stoul(argv[2]),
+        (uint32_t) std::stoul(argv[3]),
+        Util::option(argc, argv, "weights").value_or("uniform"),
+        Util::option(argc, argv, "exclusions").value_or("random"),
+        Util::option(argc, argv, "planted").has_value(),
+        std::mt19937(seed ? std::stoul(std::string(*seed)) : 1),
+    };
+
+    auto [problem, optimum] = generator.generate();
+
+    // Without a directory the instance goes to stdout
+    auto directory = Util::option(argc, argv, "output");
+    if (!directory) {
+        write(stdout, problem);
+        return 0;
+    }
+
+    std::string path = std::string(*directory) + "/mvr_" + argv[1] + "_" + argv[2] + "_" + argv[3];
+
+    FILE* file = fopen((path + ".txt").c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write instance: %s.txt\n", path.c_str());
+        exit(EXIT_FAILURE);
+    }
+    write(file, problem);
+    fclose(file);
+
+    // Planted optimum in the engines' output format, usable with --previous
+    if (!optimum.empty()) {
+        FILE* solution = fopen((path + ".sol").c_str(), "w");
+        if (!solution) {
+            fprintf(stderr, "Cannot write solution: %s.sol\n", path.c_str());
+            exit(EXIT_FAILURE);
+        }
+        fprintf(solution, "Solution: [");
+        for (size_t i = 0; i < optimum.size(); i++) {
+            fprintf(solution, i > 0 ? " %d" : "%d", optimum[i]);
+        }
+        fprintf(solution, "]\n");
+        fprintf(solution, "Weight: %f\n", problem.cut(optimum));
+        fclose(solution);
+    }
+
+    printf("%s.txt\n", path.c_str());
+    return 0;
+}
@@ -1,25 +1,39 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <queue>
-#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 #include <omp.h>
 #include <mpi.h>
 
+#include "Anytime.hpp"
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Checkpoint.hpp"
 #include "Problem.hpp"
+#include "SolutionCache.hpp"
+#include "SuspendedExecution.hpp"
+#include "Update.hpp"
 #include "Util.hpp"
 
-using VSolution = std::vector<uint8_t>;
-
-struct SuspendedExecution {
-    int pos;
+struct Result {
+    int32_t id;
     VSolution solution;
     float weight;
+    uint64_t nodes;
+    uint8_t complete;
 
     void send(int dest) const {
-        MPI_Send(&this->pos, 1, MPI_INT, dest, 0, MPI_COMM_WORLD);
+        MPI_Send(&this->id, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
 
         // Solution
         int32_t solution_size = this->solution.size();
@@ -30,101 +44,78 @@ struct SuspendedExecution {
         }
 
         MPI_Send(&this->weight, 1, MPI_FLOAT, dest, 0, MPI_COMM_WORLD);
+        MPI_Send(&this->nodes, 1, MPI_UINT64_T, dest, 0, MPI_COMM_WORLD);
+        MPI_Send(&this->complete, 1, MPI_UINT8_T, dest, 0, MPI_COMM_WORLD);
     }
 
-    static std::optional<SuspendedExecution> receive(int src) {
-        SuspendedExecution result;
-
-        MPI_Recv(&result.pos, 1, MPI_INT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    static Result receive(int src) {
+        Result result;
 
-        if (result.pos == -1) {
-            return std::nullopt;
-        }
+        MPI_Recv(&result.id, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
         // Solution
         int32_t solution_size;
         MPI_Recv(&solution_size, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
-        result.solution.resize(solution_size);
+        result.solution.reserve(solution_size);
 
         for (size_t i = 0; i < solution_size; i++) {
             uint8_t v;
             MPI_Recv(&v, 1, MPI_UINT8_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            result.solution[i] = v;
+            result.solution.push_back(v);
         }
 
         MPI_Recv(&result.weight, 1, MPI_FLOAT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(&result.nodes, 1, MPI_UINT64_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(&result.complete, 1, MPI_UINT8_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
         return result;
     }
 };
 
-struct Result {
-    VSolution solution;
-    float weight;
-
-    void send(int dest) const {
-        // Solution
-        int32_t solution_size = this->solution.size();
-        MPI_Send(&solution_size, 1, MPI_INT32_T, dest, 0, MPI_COMM_WORLD);
+// Orders the master's jobs by lower bound, a positive depth bias favours deeper jobs
+// so DFS-like dives still reach incumbents early. Depths differ once the master splits jobs for idle workers.
+struct JobPriority {
+    float depthBias = 0.0f;
 
-        for (const auto& v : this->solution) {
-            MPI_Send(&v, 1, MPI_UINT8_T, dest, 0, MPI_COMM_WORLD);
-        }
-
-        MPI_Send(&this->weight, 1, MPI_FLOAT, dest, 0, MPI_COMM_WORLD);
+    float key(const SuspendedExecution& job) const {
+        return job.weight - depthBias * job.depth;
     }
 
-    static Result receive(int src) {
-        Result result;
-
-        // Solution
-        int32_t solution_size;
-        MPI_Recv(&solution_size, 1, MPI_INT32_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-        result.solution.reserve(solution_size);
-
-        for (size_t i = 0; i < solution_size; i++) {
-            uint8_t v;
-            MPI_Recv(&v, 1, MPI_UINT8_T, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            result.solution.push_back(v);
-        }
-
-        MPI_Recv(&result.weight, 1, MPI_FLOAT, src, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-        return result;
+    bool operator()(const SuspendedExecution& a, const SuspendedExecution& b) const {
+        return key(a) > key(b);
     }
 };
 
+using JobQueue = std::priority_queue<SuspendedExecution, std::vector<SuspendedExecution>, JobPriority>;
+
 Problem problem;
+Branching branching;
+Bounding bounding;
+Anytime anytime;
 
 VSolution bestSolution;
 float bestWeight = std::numeric_limits<float>::infinity();
 
+// Levels below a job at which partial_solve hands out subjobs
 int maxDepth = 0;
 std::vector<SuspendedExecution> suspensions;
 
-void partial_solve(int pos, VSolution solution, float weight, int depth) {
-    assert(pos > 0);
-
-    // Satisfy exclusions
-    if (problem.exclusions.count(pos - 1) > 0) {
-        solution[problem.exclusions.at(pos - 1)] = Util::invert(solution[pos - 1]);
-    }
+uint64_t nodes = 0;
+#pragma omp threadprivate(nodes)
 
-    // Calculate the weight
-    for (auto [a, b, v] : problem.edges) {
-        if (b == pos - 1 && solution[a] != solution[b]) {
-            weight += v;
-        }
-    }
+// Splits the job at `depth` into jobs `levels` decisions deeper, which keep their depth in the whole tree
+void partial_solve(VSolution solution, float weight, int depth, int levels, std::vector<SuspendedExecution>& result) {
+    nodes++;
 
     // Can't do better
     if (bestWeight < weight) {
         return;
     }
 
-    if (pos == problem.n) {
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
         if (bestWeight > weight) {
             #pragma omp critical
             {
@@ -137,42 +128,27 @@ void partial_solve(int pos, VSolution solution, float weight, int depth) {
         return;
     }
 
-    // Value already set
-    if (solution[pos] != 0) {
-        partial_solve(pos + 1, std::move(solution), weight, depth);
-        return;
-    }
+    uint8_t first = branching.first(problem, solution, node);
 
-    if (depth >= maxDepth) {
-        solution[pos] = 1;
-        suspensions.push_back({ pos + 1, solution, weight });
-
-        solution[pos] = 2;
-        suspensions.push_back({ pos + 1, std::move(solution), weight });
-    }
-    else {
-        // Recurse
-        solution[pos] = 1;
-        partial_solve(pos + 1, solution, weight, depth + 1);
+    for (uint8_t side : { first, (uint8_t) Util::invert(first) }) {
+        VSolution child = solution;
+        float added = Branching::assign(problem, child, node, side);
 
-        solution[pos] = 2;
-        partial_solve(pos + 1, std::move(solution), weight, depth + 1);
+        if (levels <= 0) {
+            result.push_back({ depth + 1, std::move(child), weight + added });
+        }
+        else {
+            partial_solve(std::move(child), weight + added, depth + 1, levels - 1, result);
+        }
     }
 }
 
-void solve(int pos, VSolution solution, float weight) {
-    assert(pos > 0);
-
-    // Satisfy exclusions
-    if (problem.exclusions.count(pos - 1) > 0) {
-        solution[problem.exclusions.at(pos - 1)] = Util::invert(solution[pos - 1]);
-    }
+void solve(VSolution solution, float weight, float bound, int depth) {
+    nodes++;
 
-    // Calculate the weight
-    for (auto [a, b, v] : problem.edges) {
-        if (b == pos - 1 && solution[a] != solution[b]) {
-            weight += v;
-        }
+    // Out of time
+    if (anytime.cancelled(nodes)) {
+        return;
     }
 
     // Can't do better
@@ -180,7 +156,14 @@ void solve(int pos, VSolution solution, float weight) {
         return;
     }
 
-    if (pos == problem.n) {
+    bound = bounding.tighten(solution, weight, bound, depth);
+    if (bestWeight <= bound) {
+        return;
+    }
+
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
         if (bestWeight > weight) {
             #pragma omp critical
             {
@@ -193,24 +176,177 @@ void solve(int pos, VSolution solution, float weight) {
         return;
     }
 
-    // Value already set
-    if (solution[pos] != 0) {
-        return solve(pos + 1, std::move(solution), weight);
-    }
+    uint8_t first = branching.first(problem, solution, node);
 
     // Recurse
-    solution[pos] = 1;
-    solve(pos + 1, solution, weight);
+    VSolution child = solution;
+    float added = Branching::assign(problem, child, node, first);
+    solve(std::move(child), weight + added, bound, depth + 1);
+
+    added = Branching::assign(problem, solution, node, Util::invert(first));
+    solve(std::move(solution), weight + added, bound, depth + 1);
+}
+
+// Jobs each worker holds at once, so the next one is already local when the current one finishes
+constexpr int PREFETCH = 2;
+
+// A job from the master, split into subjobs for the worker's compute threads
+struct LocalJob {
+    int32_t id = 0;
+    size_t remaining = 0;
+    uint64_t nodes = 0;
+    bool complete = true;
+};
+
+// Either a whole job still to be split or one of its subjobs
+struct LocalTask {
+    int32_t job = 0;
+    SuspendedExecution execution;
+    bool split = false;
+};
+
+// Thread 0 sleeps in a blocking receive from the master and queues every job it gets.
+// The compute threads split jobs, solve the subjobs and report a job once its last subjob is done,
+// so THREADS counts the communication thread and at least one compute thread always runs.
+void work(int proc_num, int num_threads) {
+    int compute_threads = std::max(num_threads - 1, 1);
+
+    std::mutex mutex;
+    std::condition_variable tasks_changed;
+
+    std::deque<LocalTask> tasks;
+    std::unordered_map<int32_t, LocalJob> jobs;
+    bool stopping = false;
+
+    // Keeps the messages of one report together when several threads finish jobs at once
+    std::mutex reporting;
+
+    std::vector<double> busy(compute_threads + 1);
+    auto start_time = std::chrono::steady_clock::now();
+
+    auto report = [&](const LocalJob& job) {
+        Result result { job.id, {}, 0.0f, job.nodes, job.complete };
+        #pragma omp critical
+        {
+            result.solution = bestSolution;
+            result.weight = bestWeight;
+        }
+
+        std::lock_guard lock(reporting);
+        MPI_Send(&proc_num, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
+        result.send(0);
+    };
+
+    #pragma omp parallel num_threads(compute_threads + 1)
+    {
+        int thread = omp_get_thread_num();
+
+        if (thread == 0) {
+            while (true) {
+                auto job = SuspendedExecution::receive(0);
+
+                if (!job) {
+                    std::lock_guard lock(mutex);
+                    stopping = true;
+                    tasks_changed.notify_all();
+                    break;
+                }
+
+                // Master's incumbent, which may come from a checkpoint or another worker
+                float incumbent;
+                int32_t id;
+                MPI_Recv(&incumbent, 1, MPI_FLOAT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                MPI_Recv(&id, 1, MPI_INT32_T, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+                #pragma omp critical
+                {
+                    if (incumbent < bestWeight) {
+                        bestSolution.clear();
+                        bestWeight = incumbent;
+                    }
+                }
 
-    solution[pos] = 2;
-    solve(pos + 1, std::move(solution), weight);
+                std::lock_guard lock(mutex);
+                tasks.push_back({ id, std::move(*job), true });
+                tasks_changed.notify_one();
+            }
+        }
+        else {
+            while (true) {
+                LocalTask task;
+                {
+                    std::unique_lock lock(mutex);
+                    tasks_changed.wait(lock, [&] { return !tasks.empty() || (stopping && jobs.empty()); });
+
+                    if (tasks.empty()) {
+                        break;
+                    }
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                auto task_start = std::chrono::steady_clock::now();
+                uint64_t before = nodes;
+                std::optional<LocalJob> done;
+
+                if (task.split) {
+                    // Find partial solutions
+                    std::vector<SuspendedExecution> subjobs;
+                    partial_solve(std::move(task.execution.solution), task.execution.weight, task.execution.depth, maxDepth, subjobs);
+                    busy[thread] += std::chrono::duration<double>(std::chrono::steady_clock::now() - task_start).count();
+
+                    std::lock_guard lock(mutex);
+                    LocalJob job { task.job, subjobs.size(), nodes - before, true };
+
+                    if (subjobs.empty()) {
+                        done = job;
+                    }
+                    else {
+                        jobs[task.job] = job;
+                    }
+
+                    for (auto& execution : subjobs) {
+                        tasks.push_back({ task.job, std::move(execution), false });
+                    }
+                    tasks_changed.notify_all();
+                }
+                else {
+                    solve(std::move(task.execution.solution), task.execution.weight, task.execution.weight, task.execution.depth);
+                    busy[thread] += std::chrono::duration<double>(std::chrono::steady_clock::now() - task_start).count();
+
+                    std::lock_guard lock(mutex);
+                    auto& job = jobs[task.job];
+                    job.nodes += nodes - before;
+                    job.complete = job.complete && !anytime.cancelled();
+
+                    if (--job.remaining == 0) {
+                        done = job;
+                        jobs.erase(task.job);
+                        tasks_changed.notify_all();
+                    }
+                }
+
+                if (done) {
+                    report(*done);
+                }
+            }
+        }
+    }
+
+    // Share of the compute threads' time spent splitting and solving
+    double capacity = compute_threads * std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    double used = std::accumulate(busy.begin(), busy.end(), 0.0);
+
+    MPI_Send(&used, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+    MPI_Send(&capacity, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
 }
 
 #define LOG(format, ...) printf(("#%d " format "\n"), proc_num __VA_OPT__(,) __VA_ARGS__)
 
 int main(int argc, char** argv) {
     if (argc < 3) {
-        printf("USAGE: ./mpi PROBLEM THREADS");
+        printf("USAGE: ./mpi PROBLEM THREADS [--branching static|difference|neighbours] [--values static|cheapest] [--seed N] [--depth-bias X] [--checkpoint PATH] [--checkpoint-interval SECONDS] [--resume PATH] [--cache DIR] [--delta PATH --previous PATH] [--flow-depth D] [--time-limit SECONDS] [--progress SECONDS] [--json]");
         exit(EXIT_FAILURE);
     }
 
@@ -218,123 +354,341 @@ int main(int argc, char** argv) {
     omp_set_dynamic(0);
     omp_set_num_threads(num_threads);
 
+    // Compute threads report finished jobs while the communication thread waits in MPI_Recv
     int provided;
-    int required = MPI_THREAD_FUNNELED;
+    int required = MPI_THREAD_MULTIPLE;
     MPI_Init_thread(&argc, &argv, required, &provided);
 
+    if (provided < required) {
+        fprintf(stderr, "MPI library without MPI_THREAD_MULTIPLE support\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
     int proc_num;
     MPI_Comm_rank(MPI_COMM_WORLD, &proc_num);
 
     int num_procs;
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
 
+    // Rank 0 only dispatches, without a worker nothing would be searched
+    if (num_procs < 2) {
+        fprintf(stderr, "USAGE: mpirun -np N ./mpi ... needs N >= 2, one master and at least one worker\n");
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
     // Load or receive problem
     if (proc_num == 0) {
         // LOG("Inside master");
         problem = Problem::load(argc, const_cast<const char **>(argv));
+        branching = Branching::from_args(problem, argc, const_cast<const char **>(argv));
+
+        // Re-solve after a delta: branch on the changed edges first and bound by the base optimum
+        auto update = Update::from_args(problem, argc, const_cast<const char **>(argv));
+        if (update) {
+            problem = update->problem;
+            branching = branching.prioritize(update->touched);
+        }
 
         for (int dest = 1; dest < num_procs; dest++) {
             // LOG("Sending problem to %d", dest);
             problem.send(dest);
+            Update::send(update, dest);
         }
 
+        bounding = Bounding::from_args(problem, argc, const_cast<const char **>(argv));
+        bounding.shift = update ? update->shift : std::nullopt;
+        anytime = Anytime::from_args(argc, const_cast<const char **>(argv));
+
         // LOG("Sent problems");
 
+        auto resumed = Checkpoint::from_args(problem, argc, const_cast<const char **>(argv));
+        auto checkpoints = CheckpointWriter::from_args(problem, argc, const_cast<const char **>(argv));
+        Checkpoint previous = resumed.value_or(Checkpoint {});
+
+        auto cache = SolutionCache::from_args(argc, const_cast<const char **>(argv));
+        auto cached = cache ? cache->lookup(problem) : std::nullopt;
+        std::optional<CacheEntry> warm;
+
         // Calculate maxDepth for workers
         maxDepth = log2(num_procs) + 1;
+        if (checkpoints || anytime.enabled()) {
+            maxDepth = std::max(maxDepth, SPLIT_DEPTH);
+        }
         // LOG("Setting maxDepth = %d", maxDepth);
 
+        uint64_t total_nodes = previous.nodes;
+
+        // Queue statistics
+        size_t max_queue_length = 0;
+        size_t initial_jobs = 0;
+        size_t total_jobs = 0;
+        size_t dispatched_jobs = 0;
+        size_t discarded_jobs = 0;
+        size_t split_jobs = 0;
+        std::chrono::duration<double> total_latency {};
+        std::chrono::duration<double> max_latency {};
+
+        auto depth_bias = Util::number(argc, const_cast<const char **>(argv), "depth-bias", -std::numeric_limits<double>::max());
+        JobPriority priority { (float) depth_bias.value_or(0.0) };
+
+        auto start_time = std::chrono::steady_clock::now();
+        anytime.start();
+
+        // Jobs queued or held by a worker, and the lightest of them which bounds every solution still to be found
+        JobQueue jobs(priority);
+        std::unordered_map<int32_t, SuspendedExecution> running;
+        int32_t next_id = 0;
+
+        auto open_jobs = [&]() {
+            std::vector<SuspendedExecution> result;
+            for (auto& [id, job] : running) {
+                result.push_back(job);
+            }
+            for (JobQueue queued = jobs; !queued.empty(); queued.pop()) {
+                result.push_back(queued.top());
+            }
+            return result;
+        };
+
+        auto root = SuspendedExecution::root(problem);
+        float root_bound = bounding.tighten(root.solution, root.weight, root.weight, root.depth);
+
+        auto lower_bound = [&]() {
+            float bound = bestWeight;
+            for (const auto& job : open_jobs()) {
+                bound = std::min(bound, job.weight);
+            }
+            return std::min(bestWeight, std::max(bound, root_bound));
+        };
+
+        anytime.status = [&]() {
+            size_t open = jobs.size() + running.size();
+            return Anytime::Status { bestWeight, lower_bound(), open, total_jobs };
+        };
+
         auto elapsed_time = timed {
-            // Find partial solutions
-            VSolution solution;
-            solution.resize(problem.n);
-            solution[0] = 1;
+            // Find partial solutions, or pick up the ones left in the checkpoint
+            if (cached) {
+                // Proven optimum on disk, nothing left to search
+                bestSolution = cached->solution;
+                bestWeight = cached->weight;
+            }
+            else if (resumed) {
+                suspensions = std::move(previous.jobs);
+                bestSolution = previous.bestSolution;
+                bestWeight = previous.bestWeight;
+            }
+            else {
+                partial_solve(root.solution, root.weight, root.depth, maxDepth, suspensions);
+            }
 
-            partial_solve(1, std::move(solution), 0.0f, 0);
+            // A cached near match starts the search with an incumbent, workers get it with their first job
+            warm = cache && !cached ? cache->nearest(problem) : std::nullopt;
+            if (warm && warm->weight < bestWeight) {
+                bestSolution = warm->solution;
+                bestWeight = warm->weight;
+            }
+            else {
+                warm.reset();
+            }
+
+            // The previous optimum, and a search only as far as the bound shift leaves open
+            if (update && update->weight < bestWeight) {
+                bestSolution = update->incumbent;
+                bestWeight = update->weight;
+            }
+            if (update && bestWeight <= update->lower_bound) {
+                suspensions.clear();
+            }
 
+            auto now = std::chrono::steady_clock::now();
+
+            // Free job slots, PREFETCH per worker
             std::queue<int> workers;
-            for (int i = 1; i < num_procs; i++) {
-                workers.push(i);
+            size_t slots = (num_procs - 1) * PREFETCH;
+            std::vector<std::chrono::steady_clock::time_point> idle_since(num_procs, now);
+            for (int slot = 0; slot < PREFETCH; slot++) {
+                for (int i = 1; i < num_procs; i++) {
+                    workers.push(i);
+                }
             }
 
-            std::deque<SuspendedExecution> jobs;
-            std::move(suspensions.begin(), suspensions.end(), std::back_inserter(jobs));
+            jobs = JobQueue(priority, std::move(suspensions));
+            max_queue_length = initial_jobs = total_jobs = jobs.size();
+
+            while (!jobs.empty() || workers.size() < slots) {
+                // Out of time, wait for the busy workers and keep the rest of the queue
+                while (!jobs.empty() && !workers.empty() && !anytime.cancelled()) {
+                    // Drop jobs the incumbent already dominates, by weight or by flow bound
+                    const auto& top = jobs.top();
+                    if (top.weight >= bestWeight || bounding.tighten(top.solution, top.weight, top.weight, top.depth) >= bestWeight) {
+                        discarded_jobs++;
+                        jobs.pop();
+                        continue;
+                    }
+
+                    // Fewer queued jobs than worker slots, near the end of the search: split the best job one level
+                    // further so the last jobs are small and no worker waits for a single large one. Its children are
+                    // deeper than the rest of the queue, which is where --depth-bias starts to matter.
+                    if (jobs.size() < slots && branching.select(problem, top.solution) >= 0) {
+                        SuspendedExecution job = top;
+                        jobs.pop();
+
+                        std::vector<SuspendedExecution> children;
+                        SuspendedExecution::split(problem, branching, std::move(job), 1, children);
+                        for (auto& child : children) {
+                            jobs.push(std::move(child));
+                        }
+
+                        split_jobs++;
+                        total_jobs += children.size() - 1;
+                        max_queue_length = std::max(max_queue_length, jobs.size());
+                        continue;
+                    }
 
-            while (!jobs.empty() || workers.size() < num_procs - 1) {
-                while (!jobs.empty() && !workers.empty()) {
                     uint32_t worker = workers.front();
                     workers.pop();
 
-                    jobs.front().send(worker);
-                    jobs.pop_front();
+                    int32_t id = next_id++;
+
+                    jobs.top().send(worker);
+                    MPI_Send(&bestWeight, 1, MPI_FLOAT, worker, 0, MPI_COMM_WORLD);
+                    MPI_Send(&id, 1, MPI_INT32_T, worker, 0, MPI_COMM_WORLD);
+                    running[id] = jobs.top();
+                    jobs.pop();
+
+                    auto latency = std::chrono::steady_clock::now() - idle_since[worker];
+                    total_latency += latency;
+                    max_latency = std::max<std::chrono::duration<double>>(max_latency, latency);
+                    dispatched_jobs++;
+                }
+
+                // Every remaining job was discarded, or time ran out
+                if (workers.size() == slots) {
+                    break;
+                }
+
+                // Keep reporting progress while the workers are busy
+                if (anytime.enabled()) {
+                    int arrived = 0;
+                    while (!arrived) {
+                        MPI_Iprobe(MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &arrived, MPI_STATUS_IGNORE);
+                        if (!arrived) {
+                            anytime.poll(0);
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                    }
                 }
 
                 int worker_id;
                 MPI_Recv(&worker_id, 1, MPI_INT, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
                 auto result = Result::receive(worker_id);
+                total_nodes += result.nodes;
+                anytime.poll(result.nodes);
                 if (result.weight < bestWeight) {
                     bestSolution = std::move(result.solution);
                     bestWeight = result.weight;
                 }
 
                 // LOG("Worker %d done", maxDepth);
+                idle_since[worker_id] = std::chrono::steady_clock::now();
                 workers.push(worker_id);
+
+                // The worker ran out of time, its job is still open
+                if (!result.complete) {
+                    jobs.push(std::move(running[result.id]));
+                }
+                running.erase(result.id);
+
+                if (checkpoints && checkpoints->due()) {
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+                    checkpoints->save({ bestSolution, bestWeight, total_nodes + nodes, previous.elapsed + elapsed.count(), open_jobs() });
+                }
             }
 
             int minus_one = -1;
-            while (!workers.empty()) {
-                MPI_Send(&minus_one, 1, MPI_INT, workers.front(), 0, MPI_COMM_WORLD);
-                workers.pop();
+            for (int worker = 1; worker < num_procs; worker++) {
+                MPI_Send(&minus_one, 1, MPI_INT, worker, 0, MPI_COMM_WORLD);
             }
         };
 
+        // Utilization of the workers' compute threads
+        double min_utilization = 1.0;
+        double total_used = 0.0;
+        double total_capacity = 0.0;
+
+        for (int worker = 1; worker < num_procs; worker++) {
+            double used, capacity;
+            MPI_Recv(&used, 1, MPI_DOUBLE, worker, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Recv(&capacity, 1, MPI_DOUBLE, worker, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+            total_used += used;
+            total_capacity += capacity;
+            min_utilization = std::min(min_utilization, capacity > 0.0 ? used / capacity : 0.0);
+        }
+
+        if (checkpoints) {
+            checkpoints->save({ bestSolution, bestWeight, total_nodes + nodes, previous.elapsed + elapsed_time.count(), open_jobs() });
+            checkpoints.reset();
+        }
+
         // Print results
         printf("Variant: OpenMPI\n");
         printf("Problem: %s\n", problem.name.c_str());
         printf("Threads: %d\n", num_threads);
+        printf("Branching: %s\n", branching.name().c_str());
         printf_vector("Solution", bestSolution);
         printf("Weight: %f\n", bestWeight);
+        anytime.print_result(bestWeight, lower_bound(), problem.hash());
+        if (resumed) {
+            printf("Resumed: %zu jobs, %lu nodes, %fs before\n", initial_jobs, previous.nodes, previous.elapsed);
+        }
+        if (update) {
+            printf("Update: previous solution reweighed to %f, lower bound %f\n", update->weight, update->lower_bound);
+        }
+        if (cached) {
+            printf("Cache: hit, solved by %s in %lu nodes, %fs\n", cached->variant.c_str(), cached->nodes, cached->elapsed);
+        }
+        else if (warm) {
+            printf("Cache: warm start at %f\n", warm->weight);
+        }
+        printf("Nodes: %lu\n", total_nodes + nodes);
+        printf("Jobs: %zu dispatched, %zu discarded, %zu split for idle workers, queue length %zu\n", dispatched_jobs, discarded_jobs, split_jobs, max_queue_length);
+        printf("Dispatch latency: %fs mean, %fs max\n", dispatched_jobs > 0 ? total_latency.count() / dispatched_jobs : 0.0, max_latency.count());
+        printf("Worker utilization: %.1f%% mean, %.1f%% min\n", total_capacity > 0.0 ? 100.0 * total_used / total_capacity : 0.0, 100.0 * min_utilization);
         printf("Elapsed time: %3fs\n", elapsed_time.count());
 
+        // Only proven optima go into the cache
+        if (cache && !cached && !anytime.cancelled()) {
+            cache->store(problem, { bestSolution, bestWeight, total_nodes + nodes, previous.elapsed + elapsed_time.count(), "OpenMPI" });
+        }
+
         MPI_Finalize();
         exit(EXIT_SUCCESS);
     }
     else {
         problem = Problem::receive(0);
-        // LOG("Problem received [n=%d]", problem.n);
+        auto update = Update::receive(0, problem);
 
-        // Calculate maxDepth for threads
-        maxDepth = log2(omp_get_num_threads()) + 1;
-
-        while (auto job = SuspendedExecution::receive(0)) {
-            // LOG("Job received [pos=%d, weight=%f]", job->pos, job->weight);
-
-            // Find partial solutions
-            partial_solve(job->pos, std::move(job->solution), job->weight, 0);
-            // LOG("%d partial solutions found", suspensions.size());
-
-            #pragma omp parallel
-            {
-                #pragma omp for schedule(dynamic)
-                for (size_t i = 0; i < suspensions.size(); i++) {
-                    // LOG("Processing job %d [pos=%d, solution.size=%u, weight=%f]", i, suspensions[i].pos, suspensions[i].solution.size(), suspensions[i].weight);
-                    // printf_vector("DEBUG", suspensions[i].solution);
-                    solve(suspensions[i].pos, std::move(suspensions[i].solution), suspensions[i].weight);
-                    // LOG("Done with job %d", i);
-                }
-            }
-
-            // LOG("Solution found");
+        branching = Branching::from_args(problem, argc, const_cast<const char **>(argv));
+        bounding = Bounding::from_args(problem, argc, const_cast<const char **>(argv));
+        if (update) {
+            branching = branching.prioritize(update->touched);
+            bounding.shift = update->shift;
+        }
+        // LOG("Problem received [n=%d]", problem.n);
 
-            suspensions.clear();
+        // Workers keep the same deadline but leave progress reports to the master
+        anytime = Anytime::from_args(argc, const_cast<const char **>(argv));
+        anytime.interval.reset();
+        anytime.start();
 
-            MPI_Send(&proc_num, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-            Result result { std::move(bestSolution), bestWeight };
-            result.send(0);
+        // Calculate maxDepth for the compute threads
+        maxDepth = log2(std::max(num_threads - 1, 1)) + 1;
 
-            // LOG("Solution sent");
-        }
+        work(proc_num, num_threads);
 
         MPI_Finalize();
         exit(EXIT_SUCCESS);
@@ -0,0 +1,265 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <omp.h>
+
+#include "Anytime.hpp"
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Checkpoint.hpp"
+#include "Problem.hpp"
+#include "SolutionCache.hpp"
+#include "SuspendedExecution.hpp"
+#include "Update.hpp"
+#include "Util.hpp"
+
+// Configurations handed out to threads in order, reseeded once the list runs out
+const std::vector<std::string_view> DEFAULT_PORTFOLIO = {
+    "neighbours/static",
+    "neighbours/cheapest",
+    "static/static",
+    "difference/cheapest",
+    "static/cheapest",
+    "difference/static",
+};
+
+Problem problem;
+Anytime anytime;
+Bounding bounding;
+
+VSolution bestSolution;
+float bestWeight = std::numeric_limits<float>::infinity();
+
+// Index of the first configuration to exhaust its tree, -1 while all are searching
+std::atomic<int> winner = -1;
+
+void solve(const Branching& branching, VSolution& solution, float weight, float bound, int depth, uint64_t& nodes) {
+    nodes++;
+
+    // Another configuration already proved optimality, or out of time
+    if (winner.load(std::memory_order_relaxed) >= 0 || anytime.cancelled(nodes)) {
+        return;
+    }
+
+    // Can't do better
+    if (bestWeight < weight) {
+        return;
+    }
+
+    bound = bounding.tighten(solution, weight, bound, depth);
+    if (bestWeight <= bound) {
+        return;
+    }
+
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
+        if (bestWeight > weight) {
+            #pragma omp critical
+            {
+                if (bestWeight > weight) {
+                    bestSolution = solution;
+                    bestWeight = weight;
+                }
+            }
+        }
+        return;
+    }
+
+    // Recurse
+    Node partner = problem.partners[node];
+    uint8_t first = branching.first(problem, solution, node);
+
+    for (uint8_t side : { first, (uint8_t) Util::invert(first) }) {
+        solve(branching, solution, weight + Branching::assign(problem, solution, node, side), bound, depth + 1, nodes);
+
+        solution[node] = 0;
+        if (partner >= 0) {
+            solution[partner] = 0;
+        }
+    }
+}
+
+std::vector<Branching> portfolio(int argc, const char** argv, int num_threads) {
+    std::vector<Branching> result;
+
+    // Explicit comma separated list of `variable/value[@seed]`
+    if (auto spec = Util::option(argc, argv, "portfolio")) {
+        std::string_view rest = *spec;
+        while (!rest.empty()) {
+            auto comma = rest.find(',');
+            result.push_back(Branching::parse(problem, rest.substr(0, comma)));
+            rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        }
+    }
+    else {
+        for (int i = 0; i < num_threads; i++) {
+            auto spec = DEFAULT_PORTFOLIO[i % DEFAULT_PORTFOLIO.size()];
+            uint32_t seed = i / DEFAULT_PORTFOLIO.size();
+            result.push_back(Branching::parse(problem, std::string(spec) + "@" + std::to_string(seed)));
+        }
+    }
+
+    // Without a configuration nothing would search and there would be no winner to report
+    if (result.empty()) {
+        fprintf(stderr, "Empty portfolio, give at least one configuration or thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+int main(int argc, const char** argv) {
+    // Override thread count
+    if (argc < 3) {
+        printf("USAGE: ./portfolio PROBLEM THREADS [--portfolio VARIABLE/VALUE[@SEED],...] [--resume PATH] [--cache DIR] [--delta PATH --previous PATH] [--flow-depth D] [--time-limit SECONDS] [--progress SECONDS] [--json]");
+        exit(EXIT_FAILURE);
+    }
+
+    int num_threads = std::stoi(argv[2]);
+    if (num_threads < 1) {
+        fprintf(stderr, "Invalid thread count: %s\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    omp_set_dynamic(0);
+
+    // Load data
+    problem = Problem::load(argc, argv);
+
+    // Re-solve after a delta: every configuration branches on the changed edges first and bounds by the base optimum
+    auto update = Update::from_args(problem, argc, argv);
+    if (update) {
+        problem = update->problem;
+    }
+    bounding = Bounding::from_args(problem, argc, argv);
+    bounding.shift = update ? update->shift : std::nullopt;
+
+    anytime = Anytime::from_args(argc, argv);
+
+    auto configurations = portfolio(argc, argv, num_threads);
+    if (update) {
+        for (auto& configuration : configurations) {
+            configuration = configuration.prioritize(update->touched);
+        }
+    }
+    std::vector<uint64_t> nodes(configurations.size());
+
+    // Every configuration searches all of the jobs left in a checkpoint
+    auto resumed = Checkpoint::from_args(problem, argc, argv);
+    std::vector<SuspendedExecution> jobs;
+
+    auto cache = SolutionCache::from_args(argc, argv);
+    auto cached = cache ? cache->lookup(problem) : std::nullopt;
+
+    if (cached) {
+        // Proven optimum on disk, nothing left to search
+        bestSolution = cached->solution;
+        bestWeight = cached->weight;
+    }
+    else if (resumed) {
+        jobs = std::move(resumed->jobs);
+        bestSolution = resumed->bestSolution;
+        bestWeight = resumed->bestWeight;
+    }
+    else {
+        jobs.push_back(SuspendedExecution::root(problem));
+    }
+
+    // A cached near match starts the search with an incumbent
+    auto warm = cache && !cached ? cache->nearest(problem) : std::nullopt;
+    if (warm && warm->weight < bestWeight) {
+        bestSolution = warm->solution;
+        bestWeight = warm->weight;
+    }
+    else {
+        warm.reset();
+    }
+
+    // The previous optimum, and a search only as far as the bound shift leaves open
+    if (update && update->weight < bestWeight) {
+        bestSolution = update->incumbent;
+        bestWeight = update->weight;
+    }
+    if (update && bestWeight <= update->lower_bound) {
+        jobs.clear();
+    }
+
+    // No configuration finishes a job before the others, so only the jobs themselves and the root flow bound the optimum
+    auto root = SuspendedExecution::root(problem);
+    float root_bound = bounding.tighten(root.solution, root.weight, root.weight, root.depth);
+
+    auto lower_bound = [&]() {
+        float bound = bestWeight;
+        for (const auto& job : jobs) {
+            bound = std::min(bound, job.weight);
+        }
+        return std::min(bestWeight, std::max(bound, root_bound));
+    };
+
+    anytime.status = [&]() {
+        return Anytime::Status { bestWeight, lower_bound(), jobs.size(), jobs.size() };
+    };
+
+    // Solve problem, one configuration per thread
+    anytime.start();
+
+    auto elapsed_time = timed {
+        if (cached) {
+            return;
+        }
+
+        #pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+        for (size_t i = 0; i < configurations.size(); i++) {
+            uint64_t count = 0;
+            for (const auto& job : jobs) {
+                VSolution solution = job.solution;
+                solve(configurations[i], solution, job.weight, job.weight, job.depth, count);
+            }
+            nodes[i] = count;
+
+            // Early returns only happen once a winner is set, so this fails for everyone but the first
+            int searching = -1;
+            if (!anytime.cancelled()) {
+                winner.compare_exchange_strong(searching, (int) i);
+            }
+        }
+    };
+
+    // Print results
+    printf("Variant: Portfolio\n");
+    printf("Problem: %s\n", problem.name.c_str());
+    printf("Threads: %d\n", num_threads);
+    for (size_t i = 0; i < configurations.size(); i++) {
+        printf("Configuration %zu: %s, %lu nodes\n", i, configurations[i].name().c_str(), nodes[i]);
+    }
+    printf("Winner: %s\n", winner >= 0 ? configurations[winner].name().c_str() : "none");
+    printf_vector("Solution", bestSolution);
+    printf("Weight: %f\n", bestWeight);
+    anytime.print_result(bestWeight, lower_bound(), problem.hash());
+    if (update) {
+        printf("Update: previous solution reweighed to %f, lower bound %f\n", update->weight, update->lower_bound);
+    }
+    if (cached) {
+        printf("Cache: hit, solved by %s in %lu nodes, %fs\n", cached->variant.c_str(), cached->nodes, cached->elapsed);
+    }
+    else if (warm) {
+        printf("Cache: warm start at %f\n", warm->weight);
+    }
+    uint64_t total_nodes = std::accumulate(nodes.begin(), nodes.end(), uint64_t(0));
+    printf("Nodes: %lu\n", total_nodes);
+    printf("Elapsed time: %3fs\n", elapsed_time.count());
+
+    // Only proven optima go into the cache
+    if (cache && !cached && !anytime.cancelled()) {
+        double before = resumed ? resumed->elapsed : 0.0;
+        cache->store(problem, { bestSolution, bestWeight, total_nodes, before + elapsed_time.count(), "Portfolio" });
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Strong and weak scaling of the parallel engines on generated instances
+#
+# Usage: ./scaling.sh BUILD_DIR
+#
+# Every combination of SIZES, K and B (lists of n, k and b) is generated.
+# Strong scaling solves every instance with each thread and rank count,
+# efficiency is the sequential time over compute threads times the parallel time.
+# Weak scaling pairs growing instances with growing thread counts (WEAK, n:threads) for each k and b,
+# since tree size is not linear in n its efficiency compares nodes per compute thread and second
+# against the sequential run on the first instance.
+# MPI ranks after the first run THREADS - 1 compute threads next to their communication thread, at least one.
+
+set -euo pipefail
+
+BUILD=${1:?Usage: $0 BUILD_DIR}
+
+SIZES=${SIZES:-"30 35 40"}
+K=${K:-20}
+B=${B:-10}
+SEED=${SEED:-1}
+GENERATOR_OPTIONS=${GENERATOR_OPTIONS:-}
+
+ENGINES=${ENGINES:-"task_parallelism data_parallelism openmpi"}
+THREADS=${THREADS:-"1 2 4 8"}
+RANKS=${RANKS:-"2 3 5"}
+WEAK=${WEAK:-"30:1 35:2 40:4 45:8"}
+MPIRUN=${MPIRUN:-mpirun}
+
+INSTANCES=$(mktemp -d)
+trap 'rm -rf "$INSTANCES"' EXIT
+
+field() {
+    grep "^$1:" | sed "s/^$1: //; s/s$//"
+}
+
+# Generates the instance `n k b`
+instance() {
+    "$BUILD/generator" "$1" "$2" "$3" --seed "$SEED" $GENERATOR_OPTIONS --output "$INSTANCES" > /dev/null
+    echo "$INSTANCES/mvr_$1_$2_$3.txt"
+}
+
+# Prints `nodes time` of one run, MPI runs use `ranks` processes with `threads` each
+run() {
+    local engine=$1 problem=$2 threads=$3 ranks=$4 output
+
+    case $engine in
+        sequential) output=$("$BUILD/sequential" "$problem") ;;
+        openmpi) output=$($MPIRUN -np "$ranks" "$BUILD/openmpi" "$problem" "$threads" < /dev/null) ;;
+        *) output=$("$BUILD/$engine" "$problem" "$threads") ;;
+    esac
+
+    echo "$(field Nodes <<< "$output") $(field "Elapsed time" <<< "$output")"
+}
+
+row() {
+    printf "%-8s %-18s %4s %4s %4s %8s %6s %14s %12s %9s %11s\n" "$@"
+}
+
+# Compute threads of an MPI run with `threads` per rank and `ranks` ranks, rank 0 only dispatches
+mpi_workers() {
+    echo $(( ($1 > 1 ? $1 - 1 : 1) * ($2 - 1) ))
+}
+
+# Every configuration of an engine: `threads ranks workers`, workers counting the threads searching
+configurations() {
+    for threads in $THREADS; do
+        if [[ $1 == openmpi ]]; then
+            for ranks in $RANKS; do
+                echo "$threads $ranks $(mpi_workers "$threads" "$ranks")"
+            done
+        else
+            echo "$threads 1 $threads"
+        fi
+    done
+}
+
+row "Mode" "Engine" "N" "K" "B" "Threads" "Ranks" "Nodes" "Time" "Speedup" "Efficiency"
+
+for k in $K; do
+    for b in $B; do
+        for n in $SIZES; do
+            problem=$(instance "$n" "$k" "$b")
+            read -r nodes base <<< "$(run sequential "$problem" 1 1)"
+            row strong sequential "$n" "$k" "$b" 1 1 "$nodes" "$base" 1.00 1.00
+
+            for engine in $ENGINES; do
+                configurations "$engine" | while read -r threads ranks workers; do
+                    read -r nodes time <<< "$(run "$engine" "$problem" "$threads" "$ranks")"
+                    speedup=$(awk "BEGIN { printf \"%.2f\", $base / $time }")
+                    efficiency=$(awk "BEGIN { printf \"%.2f\", $base / ($time * $workers) }")
+                    row strong "$engine" "$n" "$k" "$b" "$threads" "$ranks" "$nodes" "$time" "$speedup" "$efficiency"
+                done
+            done
+        done
+    done
+done
+
+for k in $K; do
+    for b in $B; do
+        first=${WEAK%%:*}
+        read -r base_nodes base_time <<< "$(run sequential "$(instance "$first" "$k" "$b")" 1 1)"
+        base_rate=$(awk "BEGIN { print $base_nodes / $base_time }")
+
+        for engine in $ENGINES; do
+            for pair in $WEAK; do
+                n=${pair%%:*}
+                threads=${pair##*:}
+                ranks=1
+                workers=$threads
+
+                # MPI spreads the compute threads over two workers when it can, each adding its communication thread
+                if [[ $engine == openmpi ]]; then
+                    ranks=$(( threads > 1 ? 3 : 2 ))
+                    threads=$(( threads > 1 ? threads / 2 + 1 : 1 ))
+                    workers=$(mpi_workers "$threads" "$ranks")
+                fi
+
+                read -r nodes time <<< "$(run "$engine" "$(instance "$n" "$k" "$b")" "$threads" "$ranks")"
+                speedup=$(awk "BEGIN { printf \"%.2f\", ($nodes / $time) / $base_rate }")
+                efficiency=$(awk "BEGIN { printf \"%.2f\", ($nodes / $time) / ($base_rate * $workers) }")
+                row weak "$engine" "$n" "$k" "$b" "$threads" "$ranks" "$nodes" "$time" "$speedup" "$efficiency"
+            done
+        done
+    done
+done
@@ -4,31 +4,34 @@
 
 #include <vector>
 
+#include "Anytime.hpp"
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Checkpoint.hpp"
 #include "Problem.hpp"
+#include "SolutionCache.hpp"
+#include "SuspendedExecution.hpp"
+#include "Update.hpp"
 #include "Util.hpp"
 
-using VSolution = std::vector<uint8_t>;
-
 Problem problem;
+Branching branching;
+Bounding bounding;
+Anytime anytime;
 VSolution solution;
 
 float bestWeight = std::numeric_limits<float>::infinity();
 VSolution bestSolution;
 
-// Basic Branch & Bounds solution
-void solve(int pos, float weight) {
-    assert(pos > 0);
+uint64_t nodes = 0;
 
-    // Satisfy exclusions
-    if (problem.exclusions.count(pos - 1) > 0) {
-        solution[problem.exclusions.at(pos - 1)] = Util::invert(solution[pos - 1]);
-    }
+// Basic Branch & Bounds solution
+void solve(float weight, float bound, int depth) {
+    nodes++;
 
-    // Calculate the weight
-    for (auto [a, b, v] : problem.edges) {
-        if (b == pos - 1 && solution[a] != solution[b]) {
-            weight += v;
-        }
+    // Out of time
+    if (anytime.cancelled(nodes)) {
+        return;
     }
 
     // Can't do better
@@ -36,7 +39,14 @@ void solve(int pos, float weight) {
         return;
     }
 
-    if (pos == problem.n) {
+    bound = bounding.tighten(solution, weight, bound, depth);
+    if (bestWeight <= bound) {
+        return;
+    }
+
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
         if (bestWeight > weight) {
             bestWeight = weight;
             bestSolution = solution;
@@ -44,40 +54,145 @@ void solve(int pos, float weight) {
         return;
     }
 
-    // Value already set
-    if (solution[pos] != 0) {
-        solve(pos + 1, weight);
-        return;
-    }
-
-    // Recurse
-    solution[pos] = 1;
-    solve(pos + 1, weight);
+    // Recurse, remembering the exclusion partner so it can be restored
+    Node partner = problem.partners[node];
+    uint8_t first = branching.first(problem, solution, node);
 
-    solution[pos] = 2;
-    solve(pos + 1, weight);
+    for (uint8_t side : { first, (uint8_t) Util::invert(first) }) {
+        solve(weight + Branching::assign(problem, solution, node, side), bound, depth + 1);
 
-    solution[pos] = 0;
+        solution[node] = 0;
+        if (partner >= 0) {
+            solution[partner] = 0;
+        }
+    }
 }
 
 int main(int argc, const char** argv) {
     problem = Problem::load(argc, argv);
+    branching = Branching::from_args(problem, argc, argv);
+
+    /* Re-solve after a delta: branch on the changed edges first and bound by the base optimum */
+    auto update = Update::from_args(problem, argc, argv);
+    if (update) {
+        problem = update->problem;
+        branching = branching.prioritize(update->touched);
+    }
+    bounding = Bounding::from_args(problem, argc, argv);
+    bounding.shift = update ? update->shift : std::nullopt;
+
+    anytime = Anytime::from_args(argc, argv);
+
+    auto resumed = Checkpoint::from_args(problem, argc, argv);
+    auto checkpoints = CheckpointWriter::from_args(problem, argc, argv);
+
+    auto cache = SolutionCache::from_args(argc, argv);
+    auto cached = cache ? cache->lookup(problem) : std::nullopt;
+
+    /* Collect jobs, split finely enough to checkpoint or estimate progress between them */
+    Checkpoint previous = resumed.value_or(Checkpoint {});
+    std::vector<SuspendedExecution> jobs = std::move(previous.jobs);
+
+    if (cached) {
+        /* Proven optimum on disk, nothing left to search */
+        bestSolution = cached->solution;
+        bestWeight = cached->weight;
+        jobs.clear();
+    }
+    else if (resumed) {
+        bestSolution = previous.bestSolution;
+        bestWeight = previous.bestWeight;
+    }
+    else {
+        SuspendedExecution::split(problem, branching, SuspendedExecution::root(problem), checkpoints || anytime.enabled() ? SPLIT_DEPTH : 0, jobs);
+    }
+
+    /* A cached near match starts the search with an incumbent */
+    auto warm = cache && !cached ? cache->nearest(problem) : std::nullopt;
+    if (warm && warm->weight < bestWeight) {
+        bestSolution = warm->solution;
+        bestWeight = warm->weight;
+    }
+    else {
+        warm.reset();
+    }
+
+    /* The previous optimum, and a search only as far as the bound shift leaves open */
+    if (update && update->weight < bestWeight) {
+        bestSolution = update->incumbent;
+        bestWeight = update->weight;
+    }
+    if (update && bestWeight <= update->lower_bound) {
+        jobs.clear();
+    }
+
+    /* Jobs before `next` are finished, the lower bound is the lightest open one or the root flow bound */
+    size_t next = 0;
+    auto root = SuspendedExecution::root(problem);
+    float root_bound = bounding.tighten(root.solution, root.weight, root.weight, root.depth);
+
+    auto lower_bound = [&]() {
+        float bound = bestWeight;
+        for (size_t i = next; i < jobs.size(); i++) {
+            bound = std::min(bound, jobs[i].weight);
+        }
+        return std::min(bestWeight, std::max(bound, root_bound));
+    };
+
+    anytime.status = [&]() {
+        return Anytime::Status { bestWeight, lower_bound(), jobs.size() - next, jobs.size() };
+    };
 
     /* Solve problem */
-    auto elapsed_time = timed {
-        solution.resize(problem.n);
-        solution[0] = 1;
+    auto start_time = std::chrono::steady_clock::now();
+    anytime.start();
 
-        solve(1, 0.0f);
+    auto elapsed_time = timed {
+        while (next < jobs.size() && !anytime.cancelled()) {
+            solution = jobs[next].solution;
+            solve(jobs[next].weight, jobs[next].weight, jobs[next].depth);
+
+            if (!anytime.cancelled()) {
+                next++;
+            }
+
+            if (checkpoints && (checkpoints->due() || next == jobs.size() || anytime.cancelled())) {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+                checkpoints->save({
+                    bestSolution, bestWeight,
+                    previous.nodes + nodes, previous.elapsed + elapsed.count(),
+                    { jobs.begin() + next, jobs.end() }
+                });
+            }
+        }
     };
 
     /* Print results */
     printf("Variant: Sequential\n");
     printf("Problem: %s\n", problem.name.c_str());
+    printf("Branching: %s\n", branching.name().c_str());
     printf_vector("Solution", bestSolution);
     printf("Weight: %f\n", bestWeight);
+    anytime.print_result(bestWeight, lower_bound(), problem.hash());
+    if (resumed) {
+        printf("Resumed: %zu jobs, %lu nodes, %fs before\n", jobs.size(), previous.nodes, previous.elapsed);
+    }
+    if (update) {
+        printf("Update: previous solution reweighed to %f, lower bound %f\n", update->weight, update->lower_bound);
+    }
+    if (cached) {
+        printf("Cache: hit, solved by %s in %lu nodes, %fs\n", cached->variant.c_str(), cached->nodes, cached->elapsed);
+    }
+    else if (warm) {
+        printf("Cache: warm start at %f\n", warm->weight);
+    }
+    printf("Nodes: %lu\n", previous.nodes + nodes);
     printf("Elapsed time: %3fs\n", elapsed_time.count());
 
+    /* Only proven optima go into the cache */
+    if (cache && !cached && !anytime.cancelled()) {
+        cache->store(problem, { bestSolution, bestWeight, previous.nodes + nodes, previous.elapsed + elapsed_time.count(), "Sequential" });
+    }
+
     return 0;
 }
-
@@ -0,0 +1,463 @@
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <omp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Anytime.hpp"
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Problem.hpp"
+#include "SolutionCache.hpp"
+#include "SuspendedExecution.hpp"
+#include "Util.hpp"
+
+// Where requests come from, results go back the same way.
+// Socket streams close once the client hung up and its last result is written.
+struct Connection {
+    FILE* in;
+    FILE* out;
+    bool owned;
+    std::mutex writing;
+
+    Connection(FILE* in, FILE* out, bool owned)
+        : in(in)
+        , out(out)
+        , owned(owned)
+    {}
+
+    ~Connection() {
+        if (owned) {
+            fclose(in);
+            fclose(out);
+        }
+    }
+};
+
+struct Request {
+    Problem problem;
+    std::shared_ptr<Connection> connection;
+};
+
+// One instance being searched by a thread group, with its own incumbent and deadline
+struct Instance {
+    const Problem& problem;
+    Branching branching;
+    Bounding bounding;
+    Anytime anytime;
+
+    VSolution bestSolution;
+    float bestWeight = std::numeric_limits<float>::infinity();
+    std::mutex improving;
+
+    Instance(const Problem& problem, Branching branching, Bounding bounding, const Anytime& anytime)
+        : problem(problem)
+        , branching(std::move(branching))
+        , bounding(std::move(bounding))
+        , anytime(anytime)
+    {}
+};
+
+int argc;
+const char** argv;
+bool json = false;
+std::unique_ptr<SolutionCache> cache;
+
+std::deque<Request> requests;
+std::mutex requests_mutex;
+std::condition_variable requests_changed;
+bool closed = false;
+
+void solve(Instance& instance, VSolution& solution, float weight, float bound, int depth, uint64_t& nodes) {
+    nodes++;
+
+    // Out of time
+    if (instance.anytime.cancelled(nodes)) {
+        return;
+    }
+
+    // Can't do better
+    if (instance.bestWeight < weight) {
+        return;
+    }
+
+    bound = instance.bounding.tighten(solution, weight, bound, depth);
+    if (instance.bestWeight <= bound) {
+        return;
+    }
+
+    const Problem& problem = instance.problem;
+    Node node = instance.branching.select(problem, solution);
+
+    if (node < 0) {
+        if (instance.bestWeight > weight) {
+            std::lock_guard lock(instance.improving);
+            if (instance.bestWeight > weight) {
+                instance.bestSolution = solution;
+                instance.bestWeight = weight;
+            }
+        }
+        return;
+    }
+
+    // Recurse
+    Node partner = problem.partners[node];
+    uint8_t first = instance.branching.first(problem, solution, node);
+
+    for (uint8_t side : { first, (uint8_t) Util::invert(first) }) {
+        solve(instance, solution, weight + Branching::assign(problem, solution, node, side), bound, depth + 1, nodes);
+
+        solution[node] = 0;
+        if (partner >= 0) {
+            solution[partner] = 0;
+        }
+    }
+}
+
+std::string json_string(std::string_view value) {
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+void report(Connection& connection, const Instance& instance, float bound, uint64_t nodes, double elapsed, bool cached) {
+    std::lock_guard lock(connection.writing);
+    FILE* out = connection.out;
+
+    if (json) {
+        fprintf(out, "{\"problem\":%s,\"solution\":[", json_string(instance.problem.name).c_str());
+        for (size_t i = 0; i < instance.bestSolution.size(); i++) {
+            fprintf(out, i > 0 ? ",%d" : "%d", instance.bestSolution[i]);
+        }
+        fprintf(out, "],\"weight\":%f,\"optimal\":%s,\"bound\":%f,\"nodes\":%lu,\"elapsed\":%f,\"cached\":%s}\n",
+            instance.bestWeight, instance.anytime.cancelled() ? "false" : "true", bound, nodes, elapsed, cached ? "true" : "false");
+    }
+    else {
+        fprintf(out, "Problem: %s\n", instance.problem.name.c_str());
+        fprintf(out, "Solution: [");
+        for (size_t i = 0; i < instance.bestSolution.size(); i++) {
+            fprintf(out, i > 0 ? " %d" : "%d", instance.bestSolution[i]);
+        }
+        fprintf(out, "]\n");
+        fprintf(out, "Weight: %f\n", instance.bestWeight);
+        instance.anytime.print_result(instance.bestWeight, bound, instance.problem.hash(), out);
+        if (cached) {
+            fprintf(out, "Cache: hit\n");
+        }
+        fprintf(out, "Nodes: %lu\n", nodes);
+        fprintf(out, "Elapsed time: %3fs\n\n", elapsed);
+    }
+
+    fflush(out);
+}
+
+void report_error(Connection& connection, std::string_view request) {
+    std::lock_guard lock(connection.writing);
+
+    if (json) {
+        fprintf(connection.out, "{\"error\":%s}\n", json_string(request).c_str());
+    }
+    else {
+        fprintf(connection.out, "Error: cannot read %.*s\n\n", (int) request.size(), request.data());
+    }
+
+    fflush(connection.out);
+}
+
+// Searches one instance with a team of `num_threads`, splitting the root like the data parallel engine.
+// --time-limit applies to every instance on its own, progress events name no instance.
+void serve(Request& request, int num_threads) {
+    Instance instance(
+        request.problem,
+        Branching::from_args(request.problem, argc, argv),
+        Bounding::from_args(request.problem, argc, argv),
+        Anytime::from_args(argc, argv)
+    );
+
+    // Proven optimum on disk, otherwise a near match as the starting incumbent
+    auto cached = cache ? cache->lookup(instance.problem) : std::nullopt;
+    auto warm = cache && !cached ? cache->nearest(instance.problem) : std::nullopt;
+
+    if (cached || warm) {
+        instance.bestSolution = cached ? cached->solution : warm->solution;
+        instance.bestWeight = cached ? cached->weight : warm->weight;
+    }
+
+    if (cached) {
+        report(*request.connection, instance, instance.bestWeight, 0, 0.0, true);
+        return;
+    }
+
+    // Finer jobs to estimate progress between
+    std::vector<SuspendedExecution> jobs;
+    int levels = num_threads > 1 ? log2(num_threads) + 1 : 0;
+    if (instance.anytime.enabled()) {
+        levels = std::max(levels, SPLIT_DEPTH);
+    }
+    auto root = SuspendedExecution::root(instance.problem);
+    SuspendedExecution::split(instance.problem, instance.branching, root, levels, jobs);
+
+    // The lightest open job bounds every solution still to be found, and so does the root flow bound
+    std::vector<std::atomic<bool>> finished(jobs.size());
+    std::atomic<size_t> finished_count = 0;
+    float root_bound = instance.bounding.tighten(root.solution, root.weight, root.weight, root.depth);
+
+    auto lower_bound = [&]() {
+        float bound = instance.bestWeight;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (!finished[i]) {
+                bound = std::min(bound, jobs[i].weight);
+            }
+        }
+        return std::min(instance.bestWeight, std::max(bound, root_bound));
+    };
+
+    instance.anytime.status = [&]() {
+        return Anytime::Status { instance.bestWeight, lower_bound(), jobs.size() - finished_count, jobs.size() };
+    };
+
+    uint64_t total_nodes = 0;
+    instance.anytime.start();
+
+    auto elapsed_time = timed {
+        #pragma omp parallel for schedule(dynamic) num_threads(num_threads) reduction(+:total_nodes)
+        for (size_t i = 0; i < jobs.size(); i++) {
+            VSolution solution = jobs[i].solution;
+            solve(instance, solution, jobs[i].weight, jobs[i].weight, jobs[i].depth, total_nodes);
+
+            if (!instance.anytime.cancelled()) {
+                finished[i] = true;
+                finished_count++;
+            }
+        }
+    };
+
+    report(*request.connection, instance, lower_bound(), total_nodes, elapsed_time.count(), false);
+
+    // Only proven optima go into the cache
+    if (cache && !instance.anytime.cancelled()) {
+        cache->store(instance.problem, { instance.bestSolution, instance.bestWeight, total_nodes, elapsed_time.count(), "Service" });
+    }
+}
+
+// Lines of an inline instance: its header and as many lines as the header announces edges and exclusions,
+// so a malformed instance is skipped as a whole and the next request starts on the right line
+std::string read_inline(FILE* in) {
+    char line[4096];
+    if (!fgets(line, sizeof(line), in)) {
+        return {};
+    }
+
+    std::string text = line;
+    uint32_t n, k, b;
+    if (sscanf(line, "%u %u %u", &n, &k, &b) != 3) {
+        return text;
+    }
+
+    for (uint32_t i = 0; i < n * k / 2 + b && fgets(line, sizeof(line), in); i++) {
+        text += line;
+    }
+    return text;
+}
+
+// Reads requests until the stream ends, returns whether the client asked the service to quit.
+// A request is a problem path on its own line, or `inline [NAME]` followed by the problem text.
+// Instances that do not read as valid problems are answered with an error and never searched.
+bool read_requests(const std::shared_ptr<Connection>& connection) {
+    char line[4096];
+
+    while (fgets(line, sizeof(line), connection->in)) {
+        std::string_view request(line);
+        while (!request.empty() && isspace(request.back())) {
+            request.remove_suffix(1);
+        }
+
+        if (request.empty()) {
+            continue;
+        }
+
+        if (request == "quit") {
+            return true;
+        }
+
+        Problem problem;
+        if (request == "inline" || request.substr(0, 7) == "inline ") {
+            std::string_view name = request.size() > 7 ? request.substr(7) : "<inline>";
+            std::string text = read_inline(connection->in);
+
+            if (FILE* file = text.empty() ? nullptr : fmemopen(text.data(), text.size(), "r")) {
+                problem = Problem::read(file, name);
+                fclose(file);
+            }
+        }
+        else if (FILE* file = fopen(std::string(request).c_str(), "r")) {
+            problem = Problem::read(file, request);
+            fclose(file);
+        }
+
+        if (problem.n == 0) {
+            report_error(*connection, request);
+            continue;
+        }
+
+        std::lock_guard lock(requests_mutex);
+        requests.push_back({ std::move(problem), connection });
+        requests_changed.notify_one();
+    }
+
+    return false;
+}
+
+// Accepts clients until one of them sends `quit`. Every client gets its own reader thread, so clients
+// are served side by side and a request is queued once its text is read completely. Once `quit` arrives
+// the other clients stop being read, their queued requests are still answered.
+void listen_on(const char* path) {
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    unlink(path);
+
+    if (server < 0 || bind(server, (sockaddr*) &address, sizeof(address)) < 0 || listen(server, 16) < 0) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<std::thread> readers;
+    std::set<int> clients;
+    std::mutex clients_mutex;
+    bool quit = false;
+
+    // Shutting the sockets down wakes accept and every reader blocked on its client
+    auto stop = [&]() {
+        quit = true;
+        shutdown(server, SHUT_RDWR);
+        for (int client : clients) {
+            shutdown(client, SHUT_RD);
+        }
+    };
+
+    while (true) {
+        int client = accept(server, nullptr, nullptr);
+
+        std::lock_guard lock(clients_mutex);
+        if (quit) {
+            if (client >= 0) {
+                close(client);
+            }
+            break;
+        }
+        if (client < 0) {
+            continue;
+        }
+
+        clients.insert(client);
+        readers.emplace_back([&, client]() {
+            auto connection = std::make_shared<Connection>(fdopen(client, "r"), fdopen(dup(client), "w"), true);
+            bool asked = read_requests(connection);
+
+            // Forget the descriptor while the connection still holds it open, so it is never reused meanwhile
+            std::lock_guard lock(clients_mutex);
+            clients.erase(client);
+            if (asked && !quit) {
+                stop();
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    close(server);
+    unlink(path);
+}
+
+int main(int argc, const char** argv) {
+    if (argc < 2) {
+        printf("USAGE: ./service THREADS [--groups G] [--socket PATH] [--json] [--cache DIR] [--branching static|difference|neighbours] [--values static|cheapest] [--seed N] [--flow-depth D] [--time-limit SECONDS] [--progress SECONDS]");
+        exit(EXIT_FAILURE);
+    }
+
+    ::argc = argc;
+    ::argv = argv;
+    json = Util::option(argc, argv, "json").has_value();
+    cache = SolutionCache::from_args(argc, argv);
+
+    // Threads are split evenly into groups, each group works on one instance at a time
+    int num_threads = std::stoi(argv[1]);
+    int groups = std::min(Util::number(argc, argv, "groups", 1).value_or(1), std::max(num_threads, 1));
+    int group_threads = num_threads / groups;
+
+    omp_set_dynamic(0);
+    omp_set_max_active_levels(2);
+
+    auto socket_path = Util::option(argc, argv, "socket");
+    size_t served = 0;
+
+    // The teams stay alive between instances, thread 0 only reads requests
+    auto elapsed_time = timed {
+        #pragma omp parallel num_threads(groups + 1) reduction(+:served)
+        {
+            if (omp_get_thread_num() == 0) {
+                if (socket_path) {
+                    listen_on(std::string(*socket_path).c_str());
+                }
+                else {
+                    read_requests(std::make_shared<Connection>(stdin, stdout, false));
+                }
+
+                std::lock_guard lock(requests_mutex);
+                closed = true;
+                requests_changed.notify_all();
+            }
+            else {
+                while (true) {
+                    Request request;
+                    {
+                        std::unique_lock lock(requests_mutex);
+                        requests_changed.wait(lock, [] { return !requests.empty() || closed; });
+
+                        if (requests.empty()) {
+                            break;
+                        }
+
+                        request = std::move(requests.front());
+                        requests.pop_front();
+                    }
+
+                    serve(request, group_threads);
+                    served++;
+                }
+            }
+        }
+    };
+
+    // Summary on stderr, so results on stdout stay one format
+    fprintf(stderr, "Served: %zu instances, %d groups of %d threads\n", served, groups, group_threads);
+    fprintf(stderr, "Elapsed time: %3fs\n", elapsed_time.count());
+    fprintf(stderr, "Throughput: %f instances/s\n", elapsed_time.count() > 0.0 ? served / elapsed_time.count() : 0.0);
+
+    return 0;
+}
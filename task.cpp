@@ -1,118 +1,338 @@
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
 #include <cassert>
+#include <memory>
 #include <string_view>
 #include <vector>
 
 #include <omp.h>
 
+#include "Affinity.hpp"
+#include "Anytime.hpp"
+#include "Bounds.hpp"
+#include "Branching.hpp"
+#include "Checkpoint.hpp"
 #include "Problem.hpp"
+#include "SolutionCache.hpp"
+#include "SuspendedExecution.hpp"
+#include "Update.hpp"
 #include "Util.hpp"
 
 constexpr size_t THRESHOLD = 10;
 
-using VSolution = std::vector<uint8_t>;
-
 Problem problem;
+Branching branching;
+Bounding bounding;
+Anytime anytime;
 
 VSolution bestSolution;
 float bestWeight = std::numeric_limits<float>::infinity();
 
-std::vector<std::vector<Edge>> bedges;
+uint64_t nodes = 0;
+#pragma omp threadprivate(nodes)
+
+// Search data on the calling thread's socket, only built when --affinity pins threads
+std::vector<std::unique_ptr<Replica>> replicas;
+Replica* local = nullptr;
+#pragma omp threadprivate(local)
+
+// Pinned threads search their socket's replica, unpinned runs read the globals exactly as before
+template <bool Pinned>
+void solve(int depth, VSolution solution, float weight, float bound) {
+    nodes++;
 
-void solve(int pos, VSolution solution, float weight) {
-    assert(pos > 0);
+    const Problem& problem = Pinned ? local->problem : ::problem;
+    const Branching& branching = Pinned ? local->branching : ::branching;
+    const Bounding& bounding = Pinned ? local->bounding : ::bounding;
+    float& incumbent = Pinned ? local->bestWeight : bestWeight;
 
-    // Satisfy exclusions
-    if (problem.exclusions.count(pos - 1) > 0) {
-        solution[problem.exclusions.at(pos - 1)] = Util::invert(solution[pos - 1]);
+    // Out of time
+    if (anytime.cancelled(nodes)) {
+        return;
     }
 
-    // Calculate the weight
-    for (auto [a, b, v] : bedges[pos - 1]) {
-        if (solution[a] != solution[b]) {
-            weight += v;
-        }
+    if (Pinned && (nodes & (Replica::REFRESH - 1)) == 0 && bestWeight < incumbent) {
+        incumbent = bestWeight;
     }
 
     // Can't do better
-    if (bestWeight < weight) {
+    if (incumbent < weight) {
         return;
     }
 
-    if (pos == problem.n) {
-        if (bestWeight > weight) {
+    bound = bounding.tighten(solution, weight, bound, depth);
+    if (incumbent <= bound) {
+        return;
+    }
+
+    Node node = branching.select(problem, solution);
+
+    if (node < 0) {
+        if (incumbent > weight) {
             #pragma omp critical
             {
                 if (bestWeight > weight) {
                     bestSolution = solution;
                     bestWeight = weight;
                 }
+                if (Pinned) {
+                    incumbent = bestWeight;
+                }
             }
         }
         return;
     }
 
-    // Value already set
-    if (solution[pos] != 0) {
-        solve(pos + 1, std::move(solution), weight);
-        return;
-    }
+    uint8_t first = branching.first(problem, solution, node);
+
+    // Recurse, a task reads the replica of whichever thread runs it, pinned teams keep it on the same socket.
+    // Decisions may place two nodes, so the cutoff counts the nodes still unassigned.
+    size_t unassigned = std::count(solution.begin(), solution.end(), 0);
 
-    // Recurse
-    #pragma omp task if (pos < problem.n - THRESHOLD)
+    #pragma omp task if (unassigned > THRESHOLD)
     {
-        solution[pos] = 1;
-        solve(pos + 1, solution, weight);
+        float added = Branching::assign(Pinned ? local->problem : ::problem, solution, node, first);
+        solve<Pinned>(depth + 1, solution, weight + added, bound);
     }
 
-    solution[pos] = 2;
-    solve(pos + 1, std::move(solution), weight);
+    float added = Branching::assign(problem, solution, node, Util::invert(first));
+    solve<Pinned>(depth + 1, std::move(solution), weight + added, bound);
 }
 
 int main(int argc, const char** argv) {
     // Override thread count
     if (argc < 3) {
-        printf("USAGE: ./task PROBLEM THREADS");
+        printf("USAGE: ./task PROBLEM THREADS [--branching static|difference|neighbours] [--values static|cheapest] [--seed N] [--checkpoint PATH] [--checkpoint-interval SECONDS] [--resume PATH] [--cache DIR] [--delta PATH --previous PATH] [--flow-depth D] [--affinity numa|CORES:CORES...] [--time-limit SECONDS] [--progress SECONDS] [--json]");
         exit(EXIT_FAILURE);
     }
 
     int num_threads = std::stoi(argv[2]);
     omp_set_dynamic(0);
     omp_set_num_threads(num_threads);
+    auto affinity = Affinity::from_args(argc, argv);
+
+    // Pinned runs nest one team per socket inside a team of socket leaders
+    if (affinity) {
+        omp_set_max_active_levels(2);
+    }
 
     // Load data
     problem = Problem::load(argc, argv);
+    branching = Branching::from_args(problem, argc, argv);
+
+    // Re-solve after a delta: branch on the changed edges first and bound by the base optimum
+    auto update = Update::from_args(problem, argc, argv);
+    if (update) {
+        problem = update->problem;
+        branching = branching.prioritize(update->touched);
+    }
+    bounding = Bounding::from_args(problem, argc, argv);
+    bounding.shift = update ? update->shift : std::nullopt;
+
+    anytime = Anytime::from_args(argc, argv);
+
+    auto resumed = Checkpoint::from_args(problem, argc, argv);
+    auto checkpoints = CheckpointWriter::from_args(problem, argc, argv);
+
+    auto cache = SolutionCache::from_args(argc, argv);
+    auto cached = cache ? cache->lookup(problem) : std::nullopt;
+
+    // Collect jobs, split finely enough to checkpoint or estimate progress between them,
+    // or to deal every socket's threads jobs of their own
+    Checkpoint previous = resumed.value_or(Checkpoint {});
+    std::vector<SuspendedExecution> jobs = std::move(previous.jobs);
 
-    // Calculate bedges
-    bedges.resize(problem.n);
-    for (auto& e : problem.edges) {
-        auto [a, b, v] = e;
-        bedges[b].push_back(e);
+    if (cached) {
+        // Proven optimum on disk, nothing left to search
+        bestSolution = cached->solution;
+        bestWeight = cached->weight;
+        jobs.clear();
     }
+    else if (resumed) {
+        bestSolution = previous.bestSolution;
+        bestWeight = previous.bestWeight;
+    }
+    else {
+        SuspendedExecution::split(problem, branching, SuspendedExecution::root(problem), checkpoints || anytime.enabled() || affinity ? SPLIT_DEPTH : 0, jobs);
+    }
+
+    // A cached near match starts the search with an incumbent
+    auto warm = cache && !cached ? cache->nearest(problem) : std::nullopt;
+    if (warm && warm->weight < bestWeight) {
+        bestSolution = warm->solution;
+        bestWeight = warm->weight;
+    }
+    else {
+        warm.reset();
+    }
+
+    // The previous optimum, and a search only as far as the bound shift leaves open
+    if (update && update->weight < bestWeight) {
+        bestSolution = update->incumbent;
+        bestWeight = update->weight;
+    }
+    if (update && bestWeight <= update->lower_bound) {
+        jobs.clear();
+    }
+
+    std::vector<std::atomic<bool>> finished(jobs.size());
+    std::atomic<size_t> finished_count = 0;
+    std::atomic<uint64_t> flushed_nodes = previous.nodes;
+
+    auto open_jobs = [&]() {
+        std::vector<SuspendedExecution> result;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (!finished[i]) {
+                result.push_back(jobs[i]);
+            }
+        }
+        return result;
+    };
+
+    // The lightest open job bounds every solution still to be found, and so does the root flow bound
+    auto root = SuspendedExecution::root(problem);
+    float root_bound = bounding.tighten(root.solution, root.weight, root.weight, root.depth);
+
+    auto lower_bound = [&]() {
+        float bound = bestWeight;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (!finished[i]) {
+                bound = std::min(bound, jobs[i].weight);
+            }
+        }
+        return std::min(bestWeight, std::max(bound, root_bound));
+    };
+
+    anytime.status = [&]() {
+        return Anytime::Status { bestWeight, lower_bound(), jobs.size() - finished_count, jobs.size() };
+    };
 
     // Solve problem
-    auto elapsed_time = timed {
-        VSolution solution;
-        solution.resize(problem.n);
-        solution[0] = 1;
+    uint64_t total_nodes = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    anytime.start();
 
-        #pragma omp parallel
+    auto run = [&](size_t i) {
+        #pragma omp taskgroup
         {
-            #pragma omp single
+            if (affinity) {
+                solve<true>(jobs[i].depth, jobs[i].solution, jobs[i].weight, jobs[i].weight);
+            }
+            else {
+                solve<false>(jobs[i].depth, jobs[i].solution, jobs[i].weight, jobs[i].weight);
+            }
+        }
+
+        if (!anytime.cancelled()) {
+            finished[i] = true;
+            finished_count++;
+        }
+
+        if (checkpoints) {
+            flushed_nodes += nodes;
+            nodes = 0;
+        }
+
+        if (checkpoints && checkpoints->due()) {
+            #pragma omp critical
             {
-                solve(1, solution, 0.0f);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+                checkpoints->save({ bestSolution, bestWeight, flushed_nodes, previous.elapsed + elapsed.count(), open_jobs() });
             }
         }
     };
 
+    replicas.resize(affinity ? affinity->sockets(num_threads) : 0);
+    SocketQueues queues(jobs.size(), replicas.size());
+
+    auto elapsed_time = timed {
+        if (affinity) {
+            // One team per socket. Tasks only run in the team that created them, so subtasks of a job stay on its socket
+            // and only whole jobs move between sockets, counted as steals by the queues.
+            int sockets = replicas.size();
+
+            #pragma omp parallel num_threads(sockets) reduction(+:total_nodes)
+            {
+                int socket = omp_get_thread_num();
+                int team = (num_threads - socket + sockets - 1) / sockets;
+
+                #pragma omp parallel num_threads(team) reduction(+:total_nodes)
+                {
+                    // Pinned threads copy the search data onto their own socket before searching
+                    affinity->pin(omp_get_thread_num() * sockets + socket, num_threads);
+
+                    #pragma omp single
+                    replicas[socket] = std::make_unique<Replica>(problem, branching, bounding, bestWeight);
+
+                    local = replicas[socket].get();
+
+                    // Threads still waiting in a barrier run tasks, so nobody creates one before every local is set
+                    #pragma omp barrier
+
+                    while (auto i = queues.next(socket)) {
+                        run(*i);
+                    }
+
+                    // Subtasks of the team's other jobs may still run here, their nodes have to be counted below
+                    #pragma omp barrier
+                    total_nodes += nodes;
+                }
+            }
+        }
+        else {
+            #pragma omp parallel reduction(+:total_nodes)
+            {
+                #pragma omp single
+                {
+                    for (size_t i = 0; i < jobs.size(); i++) {
+                        #pragma omp task
+                        run(i);
+                    }
+                }
+
+                total_nodes += nodes;
+            }
+        }
+
+        total_nodes += flushed_nodes;
+    };
+
+    if (checkpoints) {
+        checkpoints->save({ bestSolution, bestWeight, total_nodes, previous.elapsed + elapsed_time.count(), open_jobs() });
+    }
+
     // Print results
     printf("Variant: Task parallelism\n");
     printf("Problem: %s\n", problem.name.c_str());
     printf("Threads: %d\n", num_threads);
+    if (affinity) {
+        printf("Affinity: %zu NUMA nodes, %lu cross-socket steals\n", replicas.size(), queues.steals());
+    }
+    printf("Branching: %s\n", branching.name().c_str());
     printf_vector("Solution", bestSolution);
     printf("Weight: %f\n", bestWeight);
+    anytime.print_result(bestWeight, lower_bound(), problem.hash());
+    if (resumed) {
+        printf("Resumed: %zu jobs, %lu nodes, %fs before\n", jobs.size(), previous.nodes, previous.elapsed);
+    }
+    if (update) {
+        printf("Update: previous solution reweighed to %f, lower bound %f\n", update->weight, update->lower_bound);
+    }
+    if (cached) {
+        printf("Cache: hit, solved by %s in %lu nodes, %fs\n", cached->variant.c_str(), cached->nodes, cached->elapsed);
+    }
+    else if (warm) {
+        printf("Cache: warm start at %f\n", warm->weight);
+    }
+    printf("Nodes: %lu\n", total_nodes);
     printf("Elapsed time: %3fs\n", elapsed_time.count());
 
+    // Only proven optima go into the cache
+    if (cache && !cached && !anytime.cancelled()) {
+        cache->store(problem, { bestSolution, bestWeight, total_nodes, previous.elapsed + elapsed_time.count(), "Task parallelism" });
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Problem.hpp"
+
+// Checks for the ctest executables, unlike assert they stay active in optimized builds
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+
+// Runs `f` in a child process and checks that it exits with a failure, the way invalid input is reported
+#define CHECK_FAILS(f) \
+    do { \
+        fflush(nullptr); \
+        pid_t child = fork(); \
+        if (child == 0) { \
+            freopen("/dev/null", "w", stderr); \
+            f(); \
+            _exit(EXIT_SUCCESS); \
+        } \
+        int status = 0; \
+        waitpid(child, &status, 0); \
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS); \
+    } while (0)
+
+namespace Testing {
+
+// Fresh directory under the system temporary directory, removed again by the destructor
+class TemporaryDirectory {
+public:
+    TemporaryDirectory()
+        : path(std::filesystem::temp_directory_path() / ("pdp-test-" + std::to_string(getpid())))
+    {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+
+    ~TemporaryDirectory() {
+        std::filesystem::remove_all(path);
+    }
+
+    std::string file(std::string_view name) const {
+        return path / name;
+    }
+
+    std::filesystem::path path;
+};
+
+inline void write_file(const std::string& path, std::string_view contents) {
+    FILE* file = fopen(path.c_str(), "w");
+    CHECK(file);
+    fwrite(contents.data(), 1, contents.size(), file);
+    fclose(file);
+}
+
+// Instance in the text format of data/
+inline Problem parse(std::string_view text, std::string_view name = "<test>") {
+    FILE* file = fmemopen((void*) text.data(), text.size(), "r");
+    CHECK(file);
+    Problem problem = Problem::read(file, name);
+    fclose(file);
+    CHECK(problem.n > 0);
+    return problem;
+}
+
+// Six nodes on a ring with three chords, nodes 0-3 and 1-4 excluded from sharing a side
+inline Problem ring() {
+    return parse(
+        "6 3 2\n"
+        "0 1 0.5\n"
+        "1 2 0.25\n"
+        "2 3 0.75\n"
+        "3 4 0.5\n"
+        "4 5 0.125\n"
+        "5 0 1.0\n"
+        "0 2 0.375\n"
+        "3 5 0.625\n"
+        "1 5 0.25\n"
+        "0 3\n"
+        "1 4\n"
+    );
+}
+
+}
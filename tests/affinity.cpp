@@ -0,0 +1,73 @@
+#include <set>
+
+#include "Testing.hpp"
+#include "../Affinity.hpp"
+
+namespace {
+
+using Nodes = std::vector<std::vector<int>>;
+
+void core_lists() {
+    auto affinity = Affinity::parse("0-3,8:4-7");
+    CHECK(affinity);
+    CHECK(affinity->nodes == Nodes({ { 0, 1, 2, 3, 8 }, { 4, 5, 6, 7 } }));
+
+    CHECK(Affinity::parse("5")->nodes == Nodes({ { 5 } }));
+    CHECK(Affinity::parse("0-1:2-3:4-5")->nodes.size() == 3);
+
+    for (const char* invalid : { "0-x", "x", "0-3x", "3-1", "-1", "0,,1", "0-", "0:4-" }) {
+        CHECK(!Affinity::parse(invalid));
+    }
+}
+
+void from_args() {
+    // The numbers are far above any core the process may use, so nothing is left to pin onto
+    const char* unusable[] = { "test", "--affinity", "100000:100001" };
+    CHECK(!Affinity::from_args(3, unusable));
+
+    const char* none[] = { "test" };
+    CHECK(!Affinity::from_args(1, none));
+
+    const char* invalid[] = { "test", "--affinity", "0-x" };
+    CHECK_FAILS([&] { Affinity::from_args(3, invalid); });
+}
+
+void sockets() {
+    Affinity affinity { { { 0, 1 }, { 2, 3 }, { 4, 5 } } };
+    CHECK(affinity.sockets(1) == 1);
+    CHECK(affinity.sockets(2) == 2);
+    CHECK(affinity.sockets(8) == 3);
+    CHECK(affinity.sockets(0) == 1);
+}
+
+void socket_queues() {
+    // Jobs dealt round-robin: socket 0 owns 0, 2, 4 and socket 1 owns 1, 3
+    SocketQueues queues(5, 2);
+    std::vector<size_t> taken;
+    while (auto job = queues.next(0)) {
+        taken.push_back(*job);
+    }
+    CHECK(taken == std::vector<size_t>({ 0, 2, 4, 1, 3 }));
+    CHECK(queues.steals() == 2);
+    CHECK(!queues.next(1));
+
+    // Every job handed out exactly once across sockets
+    SocketQueues shared(7, 3);
+    std::set<size_t> seen;
+    for (int round = 0; round < 7; round++) {
+        auto job = shared.next(round % 3);
+        CHECK(job && seen.insert(*job).second);
+    }
+    CHECK(seen.size() == 7 && shared.steals() == 0);
+    CHECK(!shared.next(0) && !shared.next(1) && !shared.next(2));
+}
+
+}
+
+int main() {
+    core_lists();
+    from_args();
+    sockets();
+    socket_queues();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "Testing.hpp"
+#include "../Bounds.hpp"
+
+namespace {
+
+// Random instance with up to n / 2 disjoint exclusion pairs, small enough to enumerate every assignment
+Problem random_problem(std::mt19937& random, uint32_t n) {
+    Problem problem;
+    problem.n = n;
+
+    std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+    std::bernoulli_distribution present(0.5);
+    for (Node a = 0; a < (Node) n; a++) {
+        for (Node b = a + 1; b < (Node) n; b++) {
+            if (present(random)) {
+                problem.edges.emplace_back(a, b, weight(random));
+            }
+        }
+    }
+
+    std::vector<Node> order(n);
+    for (Node i = 0; i < (Node) n; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), random);
+
+    uint32_t pairs = std::uniform_int_distribution<uint32_t>(0, n / 2)(random);
+    for (uint32_t i = 0; i < pairs; i++) {
+        problem.exclusions[order[2 * i]] = order[2 * i + 1];
+    }
+
+    problem.b = problem.exclusions.size();
+    problem.k = 2 * problem.edges.size() / n;
+    problem.index();
+    return problem;
+}
+
+// Cut weight of the edges between assigned nodes on different sides
+float carried(const Problem& problem, const VSolution& solution) {
+    float weight = 0.0f;
+    for (auto [a, b, v] : problem.edges) {
+        if (solution[a] != 0 && solution[b] != 0 && solution[a] != solution[b]) {
+            weight += v;
+        }
+    }
+    return weight;
+}
+
+// Lightest feasible completion of `solution`, infinity if there is none
+float best_completion(const Problem& problem, VSolution solution, Node next = 0) {
+    while (next < (Node) problem.n && solution[next] != 0) {
+        next++;
+    }
+    if (next == (Node) problem.n) {
+        return problem.cut(solution);
+    }
+
+    float best = std::numeric_limits<float>::infinity();
+    for (uint8_t side : { 1, 2 }) {
+        solution[next] = side;
+        best = std::min(best, best_completion(problem, solution, next + 1));
+    }
+    return best;
+}
+
+// The flow bound never exceeds the lightest feasible completion, and it is not trivially zero
+void below_every_completion() {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> side(0, 2);
+
+    size_t checked = 0;
+    size_t positive = 0;
+
+    for (int round = 0; round < 300; round++) {
+        Problem problem = random_problem(random, 4 + round % 9);
+        FlowBound flow(problem);
+
+        for (int trial = 0; trial < 8; trial++) {
+            VSolution solution(problem.n);
+            for (auto& value : solution) {
+                value = side(random);
+            }
+
+            float optimum = best_completion(problem, solution);
+            if (!std::isfinite(optimum)) {
+                continue;
+            }
+
+            float remaining = flow.remaining(solution);
+            float bound = carried(problem, solution) + remaining;
+            if (bound > optimum + 1e-4f) {
+                fprintf(stderr, "n=%u, trial %d: bound %f above optimum %f\n", problem.n, trial, bound, optimum);
+            }
+            CHECK(remaining >= 0.0f);
+            CHECK(bound <= optimum + 1e-4f);
+
+            checked++;
+            positive += remaining > 0.0f;
+        }
+    }
+
+    CHECK(checked > 1000);
+    CHECK(positive > checked / 4);
+}
+
+// Nothing assigned: every pair still has to be separated, two disjoint paths of one unit each
+void exclusion_paths() {
+    Problem problem = Testing::parse(
+        "4 2 1\n"
+        "0 1 1.0\n"
+        "1 2 1.0\n"
+        "2 3 1.0\n"
+        "3 0 1.0\n"
+        "0 2\n"
+    );
+
+    float remaining = FlowBound(problem).remaining(VSolution(problem.n));
+    CHECK(remaining > 1.99f && remaining <= 2.0f);
+    CHECK(best_completion(problem, VSolution(problem.n)) == 2.0f);
+}
+
+// Bounds only deepen down to --flow-depth, below it nodes inherit their parent's bound
+void flow_depth() {
+    Problem problem = Testing::ring();
+
+    const char* shallow[] = { "test", "--flow-depth", "0" };
+    Bounding none = Bounding::from_args(problem, 3, shallow);
+    CHECK(none.depth == 0);
+    CHECK(none.tighten(VSolution(problem.n), 0.0f, 0.0f, 0) == 0.0f);
+
+    const char* unset[] = { "test" };
+    Bounding all = Bounding::from_args(problem, 1, unset);
+    CHECK(all.depth == (int) problem.n / DEFAULT_FLOW_DIVISOR);
+    CHECK(all.tighten(VSolution(problem.n), 0.0f, 0.0f, 0) > 0.0f);
+
+    for (const char* invalid : { "-1", "x", "2x", "" }) {
+        const char* args[] = { "test", "--flow-depth", invalid };
+        CHECK_FAILS([&] { Bounding::from_args(problem, 3, args); });
+    }
+}
+
+}
+
+int main() {
+    below_every_completion();
+    exclusion_paths();
+    flow_depth();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cinttypes>
+#include <filesystem>
+
+#include "Testing.hpp"
+#include "../SolutionCache.hpp"
+
+namespace {
+
+CacheEntry entry(const Problem& problem, VSolution solution) {
+    return { solution, problem.cut(solution), 42, 0.25, "difference" };
+}
+
+void store_and_lookup() {
+    Testing::TemporaryDirectory directory;
+    SolutionCache cache(directory.file("cache"));
+    Problem problem = Testing::ring();
+
+    CHECK(!cache.lookup(problem));
+    cache.store(problem, entry(problem, { 1, 1, 1, 2, 2, 2 }));
+
+    auto found = cache.lookup(problem);
+    CHECK(found);
+    CHECK(found->solution == VSolution({ 1, 1, 1, 2, 2, 2 }));
+    CHECK(found->weight == problem.cut(found->solution));
+    CHECK(found->nodes == 42);
+    CHECK(found->elapsed == 0.25);
+    CHECK(found->variant == "difference");
+}
+
+void other_instances() {
+    Testing::TemporaryDirectory directory;
+    SolutionCache cache(directory.file("cache"));
+    Problem problem = Testing::ring();
+    cache.store(problem, entry(problem, { 1, 1, 1, 2, 2, 2 }));
+
+    // Another weight on one edge is another instance, the stored assignment is only a near match
+    Problem other = Testing::ring();
+    std::get<2>(other.edges.front()) += 1.0f;
+    other.index();
+    CHECK(!cache.lookup(other));
+
+    auto near = cache.nearest(other);
+    CHECK(near);
+    CHECK(near->solution == VSolution({ 1, 1, 1, 2, 2, 2 }));
+    CHECK(near->weight == other.cut(near->solution));
+
+    // Entries are only near matches for the same node count
+    Problem larger = Testing::parse("7 2 0\n0 1 1.0\n1 2 1.0\n2 3 1.0\n3 4 1.0\n4 5 1.0\n5 6 1.0\n6 0 1.0\n");
+    CHECK(!cache.nearest(larger));
+}
+
+// An entry whose weight does not match its assignment is ignored rather than trusted
+void tampered_entry() {
+    Testing::TemporaryDirectory directory;
+    SolutionCache cache(directory.file("cache"));
+    Problem problem = Testing::ring();
+
+    CacheEntry tampered = entry(problem, { 1, 1, 1, 2, 2, 2 });
+    tampered.weight -= 1.0f;
+    cache.store(problem, tampered);
+    CHECK(!cache.lookup(problem));
+}
+
+// Ring with the weight of its first edge raised, a different instance of the same size for every `i`
+Problem variant(int i) {
+    Problem problem = Testing::ring();
+    std::get<2>(problem.edges.front()) += 1.0f + i;
+    problem.index();
+    return problem;
+}
+
+// Corrupt entries are skipped, whatever sides they hold
+void corrupt_entries() {
+    Testing::TemporaryDirectory directory;
+    SolutionCache cache(directory.path);
+    Problem problem = Testing::ring();
+
+    std::string prefix = directory.file("n6-");
+    Testing::write_file(prefix + "0000000000000001.sol", "PDPCACHE1 0000000000000001 6\nWeight: 1\nSolution: [2 0 1 2 2 2]\nNodes: 1\nElapsed time: 0s\nVariant: x\n");
+    Testing::write_file(prefix + "0000000000000002.sol", "PDPCACHE1 0000000000000002 6\nWeight: 1\nSolution: [2 1 3 1 1 1]\nNodes: 1\nElapsed time: 0s\nVariant: x\n");
+    Testing::write_file(prefix + "0000000000000003.sol", "PDPCACHE1 0000000000000003 6\nWeight: 1\nSolution: [2 1");
+    CHECK(!cache.nearest(problem));
+
+    Problem empty;
+    CHECK(!cache.nearest(empty));
+}
+
+// Only the most recent entries are read, an old one is not found any more
+void recent_entries() {
+    Testing::TemporaryDirectory directory;
+    SolutionCache cache(directory.path);
+    Problem problem = Testing::ring();
+
+    VSolution light = { 1, 1, 2, 2, 2, 1 };
+    VSolution heavy = { 1, 1, 1, 2, 2, 2 };
+    CHECK(problem.cut(light) < problem.cut(heavy));
+
+    Problem old = variant(0);
+    CHECK(cache.store(old, entry(old, light)));
+    CHECK(cache.nearest(problem)->solution == light);
+
+    std::string old_path = directory.file("n6-") + [&] {
+        char name[32];
+        snprintf(name, sizeof(name), "%016" PRIx64 ".sol", old.hash());
+        return std::string(name);
+    }();
+    CHECK(std::filesystem::exists(old_path));
+    std::filesystem::last_write_time(old_path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+
+    for (int i = 1; i <= 32; i++) {
+        Problem other = variant(i);
+        CHECK(cache.store(other, entry(other, heavy)));
+    }
+    CHECK(cache.nearest(problem)->solution == heavy);
+}
+
+// A failed write reports it and leaves nothing behind
+void failed_store() {
+    Testing::TemporaryDirectory directory;
+    Problem problem = Testing::ring();
+
+    std::string blocked = directory.file("blocked");
+    Testing::write_file(blocked, "");
+    SolutionCache cache(blocked);
+    CHECK(!cache.store(problem, entry(problem, { 1, 1, 1, 2, 2, 2 })));
+    CHECK(!cache.lookup(problem));
+}
+
+}
+
+int main() {
+    store_and_lookup();
+    other_instances();
+    tampered_entry();
+    corrupt_entries();
+    recent_entries();
+    failed_store();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include <filesystem>
+
+#include "Testing.hpp"
+#include "../Checkpoint.hpp"
+
+namespace {
+
+void round_trip() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("solve.ckpt");
+    Problem problem = Testing::ring();
+
+    Checkpoint written;
+    written.bestSolution = {1, 2, 2, 1, 1, 2};
+    written.bestWeight = 1.75f;
+    written.nodes = 123456789;
+    written.elapsed = 4.5;
+    written.jobs.push_back(SuspendedExecution{2, {1, 2, 0, 0, 0, 0}, 0.5f});
+    written.jobs.push_back(SuspendedExecution{3, {1, 1, 2, 0, 0, 0}, 0.625f});
+    CHECK(written.write(path, problem.hash()));
+    CHECK(!std::filesystem::exists(path + ".tmp"));
+
+    Checkpoint read = Checkpoint::read(path, problem);
+    CHECK(read.bestSolution == written.bestSolution);
+    CHECK(read.bestWeight == written.bestWeight);
+    CHECK(read.nodes == written.nodes);
+    CHECK(read.elapsed == written.elapsed);
+    CHECK(read.jobs.size() == written.jobs.size());
+    for (size_t i = 0; i < read.jobs.size(); i++) {
+        CHECK(read.jobs[i].depth == written.jobs[i].depth);
+        CHECK(read.jobs[i].solution == written.jobs[i].solution);
+        CHECK(read.jobs[i].weight == written.jobs[i].weight);
+    }
+}
+
+// A checkpoint taken before any incumbent was found
+void no_incumbent() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("solve.ckpt");
+    Problem problem = Testing::ring();
+
+    Checkpoint written;
+    written.jobs.push_back(SuspendedExecution::root(problem));
+    CHECK(written.write(path, problem.hash()));
+
+    Checkpoint read = Checkpoint::read(path, problem);
+    CHECK(read.bestWeight == std::numeric_limits<float>::infinity());
+    CHECK(read.jobs.size() == 1);
+    CHECK(read.jobs[0].solution == written.jobs[0].solution);
+}
+
+void foreign_instance() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("solve.ckpt");
+    Problem problem = Testing::ring();
+
+    // Same size, one edge weight changed
+    Problem other = Testing::ring();
+    std::get<2>(other.edges.front()) += 1.0f;
+    other.index();
+    CHECK(other.hash() != problem.hash());
+
+    Checkpoint written;
+    written.jobs.push_back(SuspendedExecution::root(problem));
+    CHECK(written.write(path, problem.hash()));
+    CHECK_FAILS([&] { Checkpoint::read(path, other); });
+}
+
+void corrupt_file() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("solve.ckpt");
+    Problem problem = Testing::ring();
+
+    Testing::write_file(path, "PDPCKPT2 but cut short");
+    CHECK_FAILS([&] { Checkpoint::read(path, problem); });
+}
+
+// A failed write reports it and leaves the previous checkpoint readable
+void failed_write() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("solve.ckpt");
+    Problem problem = Testing::ring();
+
+    Checkpoint first;
+    first.nodes = 1;
+    first.jobs.push_back(SuspendedExecution::root(problem));
+    CHECK(first.write(path, problem.hash()));
+
+    std::filesystem::create_directory(path + ".tmp");
+    Checkpoint second = first;
+    second.nodes = 2;
+    CHECK(!second.write(path, problem.hash()));
+    CHECK(Checkpoint::read(path, problem).nodes == 1);
+}
+
+}
+
+int main() {
+    round_trip();
+    no_incumbent();
+    foreign_instance();
+    corrupt_file();
+    failed_write();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include <cinttypes>
+#include <cmath>
+
+#include "Testing.hpp"
+#include "../Update.hpp"
+
+namespace {
+
+void parse_lines() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("change.delta");
+    Testing::write_file(path,
+        "edge 0 1 1.5\n"
+        "edge 2 3 0\n"
+        "exclude 2 5\n"
+        "allow 1 4\n"
+    );
+
+    Delta delta = Delta::read(path, 6);
+    CHECK(delta.edges.size() == 2);
+    CHECK(delta.edges[0] == Edge(0, 1, 1.5f));
+    CHECK(delta.edges[1] == Edge(2, 3, 0.0f));
+    CHECK(delta.excluded.size() == 1);
+    CHECK(delta.excluded[0] == std::make_pair(2, 5));
+    CHECK(delta.allowed.size() == 1);
+    CHECK(delta.allowed[0] == std::make_pair(1, 4));
+
+    Testing::write_file(path, "");
+    CHECK(Delta::read(path, 6).edges.empty());
+}
+
+void invalid_lines() {
+    Testing::TemporaryDirectory directory;
+    std::string path = directory.file("change.delta");
+
+    const char* lines[] = {
+        "remove 0 1\n", "edge 0 1\n", "edge 0 1 1.5\nexclude 2\n", "edge 0 x 1.5\n",
+        "edge 0 6 1.5\n", "edge -1 2 1.5\n", "edge 2 2 1.5\n", "edge 0 1 -1\n", "exclude 0 6\n", "allow 7 1\n",
+    };
+    for (const char* contents : lines) {
+        Testing::write_file(path, contents);
+        CHECK_FAILS([&] { Delta::read(path, 6); });
+    }
+    CHECK_FAILS([&] { Delta::read(directory.file("missing.delta"), 6); });
+}
+
+void apply_and_shift() {
+    Problem base = Testing::ring();
+
+    Delta delta;
+    delta.edges = { { 1, 0, 1.5f }, { 2, 3, 0.0f } };
+    delta.excluded = { { 2, 5 } };
+
+    Problem updated = delta.apply(base);
+    CHECK(updated.n == base.n);
+    CHECK(updated.edges.size() == base.edges.size() - 1);
+    CHECK(updated.b == 3);
+    CHECK(updated.partners[2] == 5 && updated.partners[5] == 2);
+
+    // Both changed edges cross this assignment: 0-1 gains 1.0 and 2-3 loses its 0.75
+    VSolution solution = { 1, 2, 1, 2, 1, 2 };
+    CHECK(updated.cut(solution) == base.cut(solution) + 1.0f - 0.75f);
+
+    auto shift = delta.shift(base, 2.0f);
+    CHECK(shift);
+    CHECK(shift->base == 2.0f);
+    CHECK(shift->changes.size() == 2);
+
+    // Nothing assigned: only the removed edge may lower the weight
+    CHECK(shift->at(VSolution(base.n)) == 2.0f - 0.75f);
+
+    delta.allowed = { { 1, 4 } };
+    CHECK(!delta.shift(base, 2.0f));
+}
+
+std::optional<Update> update(const std::string& delta, const std::string& previous) {
+    const char* argv[] = { "test", "--delta", delta.c_str(), "--previous", previous.c_str() };
+    return Update::from_args(Testing::ring(), 5, argv);
+}
+
+void previous_files() {
+    Testing::TemporaryDirectory directory;
+    std::string delta = directory.file("change.delta");
+    std::string previous = directory.file("previous.out");
+    Testing::write_file(delta, "edge 0 1 1.5\nedge 2 3 0\n");
+
+    Problem base = Testing::ring();
+    char instance[64];
+    snprintf(instance, sizeof(instance), "Instance: %016" PRIx64 "\n", base.hash());
+
+    // Engine output of a proven optimum for the same instance bounds the search
+    Testing::write_file(previous, std::string(instance) + "Status: optimal\nSolution: [1 1 1 2 2 2]\n");
+    auto proven = update(delta, previous);
+    CHECK(proven);
+    CHECK(proven->shift);
+    CHECK(proven->incumbent == VSolution({ 1, 1, 1, 2, 2, 2 }));
+    CHECK(proven->weight == proven->problem.cut(proven->incumbent));
+    CHECK(proven->lower_bound == base.cut(proven->incumbent) - 0.75f);
+    CHECK(proven->touched == std::vector<Node>({ 0, 1, 2, 3 }));
+
+    // Unproven or foreign solutions are only incumbents
+    Testing::write_file(previous, std::string(instance) + "Solution: [1 1 1 2 2 2]\n");
+    auto unproven = update(delta, previous);
+    CHECK(unproven && !unproven->shift && unproven->lower_bound == 0.0f);
+
+    Testing::write_file(previous, "Instance: 0000000000000001\nStatus: optimal\nSolution: [1 1 1 2 2 2]\n");
+    auto foreign = update(delta, previous);
+    CHECK(foreign && !foreign->shift);
+
+    // An infeasible or truncated previous solution is rejected
+    Testing::write_file(previous, "Solution: [1 1 1 1 2 2]\n");
+    CHECK_FAILS([&] { update(delta, previous); });
+    Testing::write_file(previous, "Solution: [1 1 1]\n");
+    CHECK_FAILS([&] { update(delta, previous); });
+}
+
+// The new exclusion 0-2 is broken by the previous solution, one of the two nodes moves over
+void repaired_incumbent() {
+    Testing::TemporaryDirectory directory;
+    std::string delta = directory.file("change.delta");
+    std::string previous = directory.file("previous.out");
+    Testing::write_file(delta, "allow 0 3\nexclude 0 2\n");
+    Testing::write_file(previous, "Solution: [1 1 1 2 2 2]\n");
+
+    auto result = update(delta, previous);
+    CHECK(result);
+    CHECK(result->incumbent[0] == 1);
+    CHECK(result->incumbent[0] != result->incumbent[2]);
+    CHECK(std::isfinite(result->weight));
+    CHECK(result->weight == result->problem.cut(result->incumbent));
+}
+
+}
+
+int main() {
+    parse_lines();
+    invalid_lines();
+    apply_and_shift();
+    previous_files();
+    repaired_incumbent();
+    return EXIT_SUCCESS;
+}
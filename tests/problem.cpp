@@ -0,0 +1,53 @@
+#include "Testing.hpp"
+
+namespace {
+
+Problem read(std::string_view text) {
+    FILE* file = fmemopen((void*) text.data(), text.size(), "r");
+    CHECK(file);
+    Problem problem = Problem::read(file, "<test>");
+    fclose(file);
+    return problem;
+}
+
+void valid() {
+    Problem problem = Testing::ring();
+    CHECK(problem.n == 6 && problem.edges.size() == 9);
+    CHECK(problem.partners[0] == 3 && problem.partners[3] == 0);
+    CHECK(problem.partners[2] == -1);
+}
+
+// Everything the search would index out of bounds or misread is rejected as a whole
+void invalid() {
+    const char* texts[] = {
+        "",
+        "3 2\n",
+        "3 2 0\n0 1 1.0\n1 2 1.0\n",
+        "3 2 0\n0 7 1.0\n1 2 1.0\n2 0 1.0\n",
+        "3 2 0\n0 -1 1.0\n1 2 1.0\n2 0 1.0\n",
+        "3 2 0\n0 0 1.0\n1 2 1.0\n2 0 1.0\n",
+        "3 2 0\n0 1 -1.0\n1 2 1.0\n2 0 1.0\n",
+        "3 2 0\n0 1 x\n1 2 1.0\n2 0 1.0\n",
+        "4 2 1\n0 1 1.0\n1 2 1.0\n2 3 1.0\n3 0 1.0\n",
+        "4 2 1\n0 1 1.0\n1 2 1.0\n2 3 1.0\n3 0 1.0\n0 4\n",
+        "4 2 1\n0 1 1.0\n1 2 1.0\n2 3 1.0\n3 0 1.0\n2 2\n",
+        "4 2 2\n0 1 1.0\n1 2 1.0\n2 3 1.0\n3 0 1.0\n0 1\n1 2\n",
+    };
+
+    for (const char* text : texts) {
+        Problem problem = read(text);
+        if (problem.n != 0) {
+            fprintf(stderr, "accepted: %s\n", text);
+        }
+        CHECK(problem.n == 0);
+        CHECK(problem.edges.empty() && problem.exclusions.empty());
+    }
+}
+
+}
+
+int main() {
+    valid();
+    invalid();
+    return EXIT_SUCCESS;
+}